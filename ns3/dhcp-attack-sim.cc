@@ -6,6 +6,8 @@
 
 #include "ns3/dhcp-client-app.h"
 #include "ns3/dhcp-server-app.h"
+#include "ns3/dhcp-lease-journal.h"
+#include "ns3/dhcp-churn-generator.h"
 
 using namespace ns3;
 
@@ -22,13 +24,32 @@ int main(int argc, char *argv[]) {
 
   bool enableStarvatingDefense = false;
   bool enableSpoofingDefense = false;
+  bool enableAuthentication = false; // RFC 3118-style HMAC on legit replies
+
+  // Cooperating legit servers splitting clients by RFC 3074 chaddr hash
+  uint32_t numLegitServers = 1;
+  double legitFailTime = 0.0; // >0: stop the last legit server at this time to exercise failover
+
+  // Persistent lease journal for the legit server(s), one file per server
+  // ("<leaseJournal>-<index>"); empty disables it. Existing files are
+  // recovered as they are, so a saved journal pre-loads a real pool.
+  std::string leaseJournal = "";
+  bool freshJournal = false;     // discard existing journal contents first
+  uint32_t warmStartLeases = 0;  // replace server 0's journal with this many synthetic leases
+  double legitRestartTime = 0.0; // >0: restart the first legit server at this time
+
+  // Client churn: continuous arrivals/departures, reconnects use INIT-REBOOT
+  bool enableChurn = false;
+  bool enableInitReboot = true;
+  double churnStart = 2.0;
+  double churnStop = 20.0;
 
   // Create nodes
   NodeContainer clients;
   clients.Create(numClients);
 
   NodeContainer legitServer, rogueServer;
-  legitServer.Create(1);
+  legitServer.Create(numLegitServers);
   rogueServer.Create(1);
 
   NodeContainer all;
@@ -65,20 +86,69 @@ int main(int argc, char *argv[]) {
   rogue->Setup(Ipv4Address("192.168.100.1"), rogue_pool, port, MilliSeconds(1)); // fast
   rogue->SetStartTime(Seconds(3.0));
   rogueServer.Get(0)->AddApplication(rogue);
+  DhcpClientApp::AddRogueServer(rogueServer.Get(0)->GetObject<Ipv4>()->GetAddress(1,0).GetLocal());
   
 
-  // Legitimate DHCP Server (slower)
-  Ptr<DhcpServerApp> legit = CreateObject<DhcpServerApp>();
-  legit->Setup(Ipv4Address("10.10.10.1"), 100, port, MilliSeconds(3)); // slow
-  legit->EnableDefense(enableStarvatingDefense); // Enable defense mechanism
-  legitServer.Get(0)->AddApplication(legit);
-  legit->SetStartTime(Seconds(0.0));
+  // Legitimate DHCP Server(s) (slower), sharing one pool kept in sync
+  std::vector<Ipv4Address> legitIps;
+  for (uint32_t i = 0; i < numLegitServers; ++i) {
+    legitIps.push_back(legitServer.Get(i)->GetObject<Ipv4>()->GetAddress(1,0).GetLocal());
+    DhcpClientApp::AddLegitServer(legitIps.back());
+  }
+  std::vector<Ptr<DhcpServerApp>> legitApps;
+  auto installLegit = [&](uint32_t i) {
+    Ptr<DhcpServerApp> legit = CreateObject<DhcpServerApp>();
+    legit->Setup(Ipv4Address("10.10.10.1"), 100, port, MilliSeconds(3)); // slow
+    legit->EnableDefense(enableStarvatingDefense); // Enable defense mechanism
+    if (numLegitServers > 1) {
+      legit->SetLoadBalancing(i, numLegitServers);
+      for (uint32_t j = 0; j < numLegitServers; ++j) {
+        if (j != i) legit->AddPeer(j, legitIps[j]);
+      }
+    }
+    if (enableAuthentication) {
+      legit->SetAuthKey(i + 1, "legit-secret-" + std::to_string(i)); // per-server key
+    }
+    if (!leaseJournal.empty()) {
+      legit->SetLeaseJournal(leaseJournal + "-" + std::to_string(i));
+    }
+    legitServer.Get(i)->AddApplication(legit);
+    legitApps.push_back(legit);
+    return legit;
+  };
+  for (uint32_t i = 0; i < numLegitServers; ++i) {
+    if (!leaseJournal.empty()) {
+      std::string path = leaseJournal + "-" + std::to_string(i);
+      if (i == 0 && warmStartLeases > 0) {
+        DhcpLeaseJournal::Generate(path, Ipv4Address("10.10.10.1"), warmStartLeases);
+      } else if (freshJournal) {
+        DhcpLeaseJournal::Generate(path, Ipv4Address("10.10.10.1"), 0);
+      }
+    }
+    Ptr<DhcpServerApp> legit = installLegit(i);
+    legit->SetStartTime(Seconds(0.0));
+    if (legitFailTime > 0 && numLegitServers > 1 && i == numLegitServers - 1) {
+      legit->SetStopTime(Seconds(legitFailTime));
+    }
+    if (legitRestartTime > 0 && i == 0) {
+      // The replacement recovers its bindings from the journal on start
+      legit->SetStopTime(Seconds(legitRestartTime));
+      installLegit(i)->SetStartTime(Seconds(legitRestartTime + 0.1));
+    }
+  }
 
   std::cout << "Rogue server node IP: " << rogueServer.Get(0)->GetObject<Ipv4>()->GetAddress(1,0).GetLocal() << std::endl;
-  std::cout << "Legit server node IP: " << legitServer.Get(0)->GetObject<Ipv4>()->GetAddress(1,0).GetLocal() << std::endl;
+  for (const Ipv4Address &ip : legitIps) {
+    std::cout << "Legit server node IP: " << ip << std::endl;
+  }
 
   
 
+  Ptr<DhcpChurnGenerator> churn = CreateObject<DhcpChurnGenerator>();
+  if (enableChurn) {
+    churn->Start(Seconds(churnStart), Seconds(churnStop));
+  }
+
   for (uint32_t i = 0; i < numClients; ++i) {
     Ptr<Node> node = clients.Get(i);
     Ptr<DhcpClientApp> client = CreateObject<DhcpClientApp>();
@@ -91,14 +161,30 @@ int main(int argc, char *argv[]) {
     if(enableSpoofingDefense) {
         // Add legitimate DHCP server to whitelist
         client->EnableSpoofingDefense(true);
-        client->AddTrustedServer(Ipv4Address("10.1.1.141")); // Legitimate server IP
+        for (const Ipv4Address &ip : legitIps) {
+            client->AddTrustedServer(ip); // Legitimate server IP
+        }
     } else {
         // No spoofing defense, so add rogue server to whitelist
         client->EnableSpoofingDefense(false);
     }
 
+    if (enableAuthentication) {
+        client->EnableAuthentication(true);
+        for (uint32_t j = 0; j < numLegitServers; ++j) {
+            client->AddServerKey(j + 1, "legit-secret-" + std::to_string(j));
+        }
+    }
+
     double jitter = (rand() % 100) / 1000.0; // 0–0.099s
-    client->SetStartTime(Seconds(2.0 + i * 0.2 + jitter));
+    if (enableChurn && i != 0) {
+        // The generator decides when each client joins; just have it ready
+        client->EnableInitReboot(enableInitReboot);
+        churn->AddClient(client);
+        client->SetStartTime(Seconds(1.0));
+    } else {
+        client->SetStartTime(Seconds(2.0 + i * 0.2 + jitter));
+    }
     client->SetStopTime(Seconds(20.0));
     node->AddApplication(client);
 }
@@ -118,6 +204,32 @@ int main(int argc, char *argv[]) {
             << " (" << (total > 0 ? 100.0 * rogueAssigned / total : 0) << "%)" << std::endl;
   std::cout << "From Legit Server     : " << legitAssigned
             << " (" << (total > 0 ? 100.0 * legitAssigned / total : 0) << "%)" << std::endl;
+  std::cout << "Legit OFFER latency  : "
+            << (DhcpClientApp::s_legitOffers > 0
+                  ? DhcpClientApp::s_legitOfferLatency.GetSeconds() * 1000.0 / DhcpClientApp::s_legitOffers
+                  : 0) << " ms avg over " << DhcpClientApp::s_legitOffers << " offers" << std::endl;
+  if (enableChurn) {
+    uint32_t rx = 0, allocations = 0, releases = 0;
+    for (Ptr<DhcpServerApp> app : legitApps) {
+      rx += app->GetRxCount();
+      allocations += app->GetAllocationCount();
+      releases += app->GetReleaseCount();
+    }
+    std::cout << "Churn arrivals/rejoins/departures: " << churn->GetArrivals() << "/"
+              << churn->GetRejoins() << "/" << churn->GetDepartures() << std::endl;
+    std::cout << "Lease grants (ACKs)  : " << DhcpClientApp::s_legitLeases << " legit, "
+              << DhcpClientApp::s_rogueLeases << " rogue over all sessions" << std::endl;
+    std::cout << "Legit server load    : " << rx / (churnStop - churnStart) << " msgs/s, "
+              << allocations << " allocations, " << releases << " releases" << std::endl;
+    std::cout << "Join latency DISCOVER: "
+              << (DhcpClientApp::s_discoverJoins > 0
+                    ? DhcpClientApp::s_discoverJoinLatency.GetSeconds() * 1000.0 / DhcpClientApp::s_discoverJoins
+                    : 0) << " ms avg over " << DhcpClientApp::s_discoverJoins << " joins" << std::endl;
+    std::cout << "Join latency REBOOT  : "
+              << (DhcpClientApp::s_reboots > 0
+                    ? DhcpClientApp::s_rebootLatency.GetSeconds() * 1000.0 / DhcpClientApp::s_reboots
+                    : 0) << " ms avg over " << DhcpClientApp::s_reboots << " rejoins" << std::endl;
+  }
   std::cout << "===================================" << std::endl;
 
   // Write results to a file for comparison
@@ -125,6 +237,8 @@ int main(int argc, char *argv[]) {
   fname << "results/defence_numClients" << numClients << "_runningTime" << runningTime << "_roguePoolSize_"<< rogue_pool <<"_both_defence_off.txt";
   std::ofstream outfile(fname.str()); // overwrite mode
   outfile << "numClients: " << numClients << std::endl;
+  outfile << "numLegitServers: " << numLegitServers << std::endl;
+  outfile << "warmStartLeases: " << warmStartLeases << std::endl;
   outfile << "Total clients with IP: " << total << std::endl;
   outfile << "From Rogue Server     : " << rogueAssigned
           << " (" << (total > 0 ? 100.0 * rogueAssigned / total : 0) << "%)" << std::endl;
@@ -0,0 +1,115 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include "ns3/dhcp-auth.h"
+
+#include <chrono>
+#include <cstring>
+#include <set>
+#include <vector>
+
+using namespace ns3;
+
+// Cost of RFC 3118-style reply authentication against the IP whitelist it
+// replaces, for one OFFER per client at 10k clients. CPU cost is wall-clock
+// per message; wire cost is the extra option bytes on a 100 Mbps link.
+
+static volatile uint32_t g_sink; // keeps the measured loops from being optimised away
+
+template <class F>
+static double NsPerMessage(uint32_t messages, uint32_t rounds, F f) {
+  auto begin = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < rounds; ++r) {
+    for (uint32_t i = 0; i < messages; ++i) f(i);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+  return ns / ((double) messages * rounds);
+}
+
+static void BuildOffer(uint8_t *buf, uint32_t index) {
+  memset(buf, 0, 300);
+  buf[0] = 2; buf[1] = 1; buf[2] = 6; buf[3] = 0;
+  buf[4] = (index >> 24) & 0xFF;
+  buf[5] = (index >> 16) & 0xFF;
+  buf[6] = (index >> 8) & 0xFF;
+  buf[7] = index & 0xFF;
+  uint32_t ip = Ipv4Address("10.10.0.1").Get() + index;
+  buf[16] = (ip >> 24) & 0xFF;
+  buf[17] = (ip >> 16) & 0xFF;
+  buf[18] = (ip >> 8) & 0xFF;
+  buf[19] = ip & 0xFF;
+  buf[28] = 0x02; buf[30] = (index >> 8) & 0xFF; buf[31] = index & 0xFF;
+  buf[236] = 99; buf[237] = 130; buf[238] = 83; buf[239] = 99;
+  buf[240] = 53; buf[241] = 1; buf[242] = 2; // DHCPOFFER
+  buf[243] = 255;
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t numClients = 10000;
+  uint32_t rounds = 20;
+  std::string secret = "legit-secret-0";
+  double linkRate = 100e6; // matches the CSMA channel in dhcp-attack-sim
+
+  std::vector<std::vector<uint8_t>> plain(numClients, std::vector<uint8_t>(300));
+  std::vector<std::vector<uint8_t>> signedMsgs(numClients, std::vector<uint8_t>(300));
+  std::vector<uint32_t> signedLen(numClients);
+  std::vector<Ipv4Address> sources(numClients);
+
+  DhcpAuthKey key(1, secret);
+  for (uint32_t i = 0; i < numClients; ++i) {
+    BuildOffer(plain[i].data(), i);
+    signedMsgs[i] = plain[i];
+    signedLen[i] = key.Sign(signedMsgs[i].data(), 243, i + 1);
+    sources[i] = (i % 2) ? Ipv4Address("10.1.1.141") : Ipv4Address("10.1.1.142");
+  }
+
+  // Baseline: client-side whitelist lookup on the source address
+  std::set<Ipv4Address> whitelist;
+  whitelist.insert(Ipv4Address("10.1.1.141"));
+  double whitelistNs = NsPerMessage(numClients, rounds, [&](uint32_t i) {
+    g_sink = g_sink + (whitelist.find(sources[i]) != whitelist.end());
+  });
+
+  // Server: sign each reply with the precomputed key states...
+  uint8_t buf[300];
+  uint64_t replay = 0;
+  double signNs = NsPerMessage(numClients, rounds, [&](uint32_t i) {
+    memcpy(buf, plain[i].data(), 300);
+    g_sink = g_sink + key.Sign(buf, 243, ++replay);
+  });
+  // ...and, for comparison, rehashing the key pads every time
+  double signUncachedNs = NsPerMessage(numClients, rounds, [&](uint32_t i) {
+    memcpy(buf, plain[i].data(), 300);
+    g_sink = g_sink + DhcpAuthKey(1, secret).Sign(buf, 243, ++replay);
+  });
+
+  // Client: find the option, verify the HMAC and check the replay counter
+  std::vector<uint64_t> lastReplay(numClients, 0);
+  uint32_t verified = 0;
+  double verifyNs = NsPerMessage(numClients, 1, [&](uint32_t i) {
+    DhcpAuthOption auth;
+    if (DhcpAuthKey::FindOption(signedMsgs[i].data(), signedLen[i], auth) &&
+        key.Verify(signedMsgs[i].data(), signedLen[i], auth) && auth.replay > lastReplay[i]) {
+      lastReplay[i] = auth.replay;
+      verified++;
+    }
+  });
+
+  uint32_t optionBytes = DhcpAuthKey::OPTION_LEN + 2;
+  double wireNs = optionBytes * 8 / linkRate * 1e9;
+  // One DORA exchange carries two signed replies (OFFER and ACK)
+  double exchangeUs = 2 * (signNs + verifyNs - whitelistNs + wireNs) / 1000.0;
+
+  std::cout << "========= DHCP Authentication Benchmark =========" << std::endl;
+  std::cout << "Clients               : " << numClients << " (" << verified << " verified)" << std::endl;
+  std::cout << "Whitelist check       : " << whitelistNs << " ns/msg" << std::endl;
+  std::cout << "HMAC sign (cached)    : " << signNs << " ns/msg, " << 1e9 / signNs << " msgs/s" << std::endl;
+  std::cout << "HMAC sign (uncached)  : " << signUncachedNs << " ns/msg, " << 1e9 / signUncachedNs << " msgs/s" << std::endl;
+  std::cout << "Verify + replay check : " << verifyNs << " ns/msg, " << 1e9 / verifyNs << " msgs/s" << std::endl;
+  std::cout << "Option size           : " << optionBytes << " bytes, " << wireNs << " ns on the wire" << std::endl;
+  std::cout << "Added per exchange    : " << exchangeUs << " us over the whitelist" << std::endl;
+  std::cout << "Sign+verify for all   : " << numClients * 2 * (signNs + verifyNs) / 1e6 << " ms" << std::endl;
+  std::cout << "=================================================" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,342 @@
+/* dhcp-auth.cc */
+
+#include "dhcp-auth.h"
+
+#include <cstring>
+
+namespace ns3
+{
+
+// Offsets inside the authentication option
+static const uint32_t AUTH_REPLAY = 5;
+static const uint32_t AUTH_SECRET_ID = 13;
+static const uint32_t AUTH_HMAC = 17;
+static const uint32_t MAX_DHCP_LEN = 576;
+
+DhcpMd5::DhcpMd5()
+    : m_bytes(0)
+{
+    m_state[0] = 0x67452301;
+    m_state[1] = 0xefcdab89;
+    m_state[2] = 0x98badcfe;
+    m_state[3] = 0x10325476;
+}
+
+void
+DhcpMd5::Transform(const uint8_t block[64])
+{
+    uint32_t m[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        m[i] = block[i * 4] | (block[i * 4 + 1] << 8) | (block[i * 4 + 2] << 16) |
+               ((uint32_t)block[i * 4 + 3] << 24);
+    }
+    uint32_t a = m_state[0];
+    uint32_t b = m_state[1];
+    uint32_t c = m_state[2];
+    uint32_t d = m_state[3];
+
+    // Fully unrolled (RFC 1321 reference form) so shifts and message
+    // indices are constants
+#define MD5_ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define MD5_FF(a, b, c, d, x, s, k) a = b + MD5_ROTL(a + ((b & c) | (~b & d)) + x + k, s)
+#define MD5_GG(a, b, c, d, x, s, k) a = b + MD5_ROTL(a + ((b & d) | (c & ~d)) + x + k, s)
+#define MD5_HH(a, b, c, d, x, s, k) a = b + MD5_ROTL(a + (b ^ c ^ d) + x + k, s)
+#define MD5_II(a, b, c, d, x, s, k) a = b + MD5_ROTL(a + (c ^ (b | ~d)) + x + k, s)
+    MD5_FF(a, b, c, d, m[0], 7, 0xd76aa478);
+    MD5_FF(d, a, b, c, m[1], 12, 0xe8c7b756);
+    MD5_FF(c, d, a, b, m[2], 17, 0x242070db);
+    MD5_FF(b, c, d, a, m[3], 22, 0xc1bdceee);
+    MD5_FF(a, b, c, d, m[4], 7, 0xf57c0faf);
+    MD5_FF(d, a, b, c, m[5], 12, 0x4787c62a);
+    MD5_FF(c, d, a, b, m[6], 17, 0xa8304613);
+    MD5_FF(b, c, d, a, m[7], 22, 0xfd469501);
+    MD5_FF(a, b, c, d, m[8], 7, 0x698098d8);
+    MD5_FF(d, a, b, c, m[9], 12, 0x8b44f7af);
+    MD5_FF(c, d, a, b, m[10], 17, 0xffff5bb1);
+    MD5_FF(b, c, d, a, m[11], 22, 0x895cd7be);
+    MD5_FF(a, b, c, d, m[12], 7, 0x6b901122);
+    MD5_FF(d, a, b, c, m[13], 12, 0xfd987193);
+    MD5_FF(c, d, a, b, m[14], 17, 0xa679438e);
+    MD5_FF(b, c, d, a, m[15], 22, 0x49b40821);
+
+    MD5_GG(a, b, c, d, m[1], 5, 0xf61e2562);
+    MD5_GG(d, a, b, c, m[6], 9, 0xc040b340);
+    MD5_GG(c, d, a, b, m[11], 14, 0x265e5a51);
+    MD5_GG(b, c, d, a, m[0], 20, 0xe9b6c7aa);
+    MD5_GG(a, b, c, d, m[5], 5, 0xd62f105d);
+    MD5_GG(d, a, b, c, m[10], 9, 0x02441453);
+    MD5_GG(c, d, a, b, m[15], 14, 0xd8a1e681);
+    MD5_GG(b, c, d, a, m[4], 20, 0xe7d3fbc8);
+    MD5_GG(a, b, c, d, m[9], 5, 0x21e1cde6);
+    MD5_GG(d, a, b, c, m[14], 9, 0xc33707d6);
+    MD5_GG(c, d, a, b, m[3], 14, 0xf4d50d87);
+    MD5_GG(b, c, d, a, m[8], 20, 0x455a14ed);
+    MD5_GG(a, b, c, d, m[13], 5, 0xa9e3e905);
+    MD5_GG(d, a, b, c, m[2], 9, 0xfcefa3f8);
+    MD5_GG(c, d, a, b, m[7], 14, 0x676f02d9);
+    MD5_GG(b, c, d, a, m[12], 20, 0x8d2a4c8a);
+
+    MD5_HH(a, b, c, d, m[5], 4, 0xfffa3942);
+    MD5_HH(d, a, b, c, m[8], 11, 0x8771f681);
+    MD5_HH(c, d, a, b, m[11], 16, 0x6d9d6122);
+    MD5_HH(b, c, d, a, m[14], 23, 0xfde5380c);
+    MD5_HH(a, b, c, d, m[1], 4, 0xa4beea44);
+    MD5_HH(d, a, b, c, m[4], 11, 0x4bdecfa9);
+    MD5_HH(c, d, a, b, m[7], 16, 0xf6bb4b60);
+    MD5_HH(b, c, d, a, m[10], 23, 0xbebfbc70);
+    MD5_HH(a, b, c, d, m[13], 4, 0x289b7ec6);
+    MD5_HH(d, a, b, c, m[0], 11, 0xeaa127fa);
+    MD5_HH(c, d, a, b, m[3], 16, 0xd4ef3085);
+    MD5_HH(b, c, d, a, m[6], 23, 0x04881d05);
+    MD5_HH(a, b, c, d, m[9], 4, 0xd9d4d039);
+    MD5_HH(d, a, b, c, m[12], 11, 0xe6db99e5);
+    MD5_HH(c, d, a, b, m[15], 16, 0x1fa27cf8);
+    MD5_HH(b, c, d, a, m[2], 23, 0xc4ac5665);
+
+    MD5_II(a, b, c, d, m[0], 6, 0xf4292244);
+    MD5_II(d, a, b, c, m[7], 10, 0x432aff97);
+    MD5_II(c, d, a, b, m[14], 15, 0xab9423a7);
+    MD5_II(b, c, d, a, m[5], 21, 0xfc93a039);
+    MD5_II(a, b, c, d, m[12], 6, 0x655b59c3);
+    MD5_II(d, a, b, c, m[3], 10, 0x8f0ccc92);
+    MD5_II(c, d, a, b, m[10], 15, 0xffeff47d);
+    MD5_II(b, c, d, a, m[1], 21, 0x85845dd1);
+    MD5_II(a, b, c, d, m[8], 6, 0x6fa87e4f);
+    MD5_II(d, a, b, c, m[15], 10, 0xfe2ce6e0);
+    MD5_II(c, d, a, b, m[6], 15, 0xa3014314);
+    MD5_II(b, c, d, a, m[13], 21, 0x4e0811a1);
+    MD5_II(a, b, c, d, m[4], 6, 0xf7537e82);
+    MD5_II(d, a, b, c, m[11], 10, 0xbd3af235);
+    MD5_II(c, d, a, b, m[2], 15, 0x2ad7d2bb);
+    MD5_II(b, c, d, a, m[9], 21, 0xeb86d391);
+#undef MD5_FF
+#undef MD5_GG
+#undef MD5_HH
+#undef MD5_II
+#undef MD5_ROTL
+
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+}
+
+void
+DhcpMd5::Update(const uint8_t* data, uint32_t len)
+{
+    uint32_t used = m_bytes % 64;
+    m_bytes += len;
+    if (used > 0)
+    {
+        uint32_t n = 64 - used < len ? 64 - used : len;
+        memcpy(m_buf + used, data, n);
+        data += n;
+        len -= n;
+        if (used + n < 64)
+        {
+            return;
+        }
+        Transform(m_buf);
+    }
+    for (; len >= 64; data += 64, len -= 64)
+    {
+        Transform(data);
+    }
+    memcpy(m_buf, data, len);
+}
+
+void
+DhcpMd5::Final(uint8_t digest[16])
+{
+    uint64_t bits = m_bytes * 8;
+    uint8_t pad[72] = {0x80};
+    uint32_t used = m_bytes % 64;
+    uint32_t padLen = used < 56 ? 56 - used : 120 - used;
+    uint8_t lenLe[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        lenLe[i] = (bits >> (8 * i)) & 0xFF;
+    }
+    Update(pad, padLen);
+    Update(lenLe, 8);
+    for (int i = 0; i < 4; ++i)
+    {
+        digest[i * 4] = m_state[i] & 0xFF;
+        digest[i * 4 + 1] = (m_state[i] >> 8) & 0xFF;
+        digest[i * 4 + 2] = (m_state[i] >> 16) & 0xFF;
+        digest[i * 4 + 3] = (m_state[i] >> 24) & 0xFF;
+    }
+}
+
+// Hash the secret down to a 64-byte block as HMAC (RFC 2104) requires
+static void
+PadKey(const std::string& secret, uint8_t block[64])
+{
+    memset(block, 0, 64);
+    if (secret.size() > 64)
+    {
+        DhcpMd5 md5;
+        md5.Update((const uint8_t*)secret.data(), secret.size());
+        md5.Final(block);
+    }
+    else
+    {
+        memcpy(block, secret.data(), secret.size());
+    }
+}
+
+DhcpAuthKey::DhcpAuthKey()
+    : m_set(false),
+      m_secretId(0)
+{
+}
+
+DhcpAuthKey::DhcpAuthKey(uint32_t secretId, const std::string& secret)
+    : m_set(true),
+      m_secretId(secretId)
+{
+    uint8_t key[64];
+    uint8_t pad[64];
+    PadKey(secret, key);
+    for (int i = 0; i < 64; ++i)
+    {
+        pad[i] = key[i] ^ 0x36;
+    }
+    m_inner.Update(pad, 64);
+    for (int i = 0; i < 64; ++i)
+    {
+        pad[i] = key[i] ^ 0x5c;
+    }
+    m_outer.Update(pad, 64);
+}
+
+bool
+DhcpAuthKey::IsSet() const
+{
+    return m_set;
+}
+
+uint32_t
+DhcpAuthKey::GetSecretId() const
+{
+    return m_secretId;
+}
+
+void
+DhcpAuthKey::Hmac(const uint8_t* msg, uint32_t len, uint8_t mac[16]) const
+{
+    uint8_t innerDigest[16];
+    DhcpMd5 inner = m_inner;
+    inner.Update(msg, len);
+    inner.Final(innerDigest);
+    DhcpMd5 outer = m_outer;
+    outer.Update(innerDigest, 16);
+    outer.Final(mac);
+}
+
+void
+DhcpAuthKey::HmacUncached(const std::string& secret,
+                          const uint8_t* msg,
+                          uint32_t len,
+                          uint8_t mac[16])
+{
+    DhcpAuthKey key(0, secret);
+    key.Hmac(msg, len, mac);
+}
+
+uint32_t
+DhcpAuthKey::Sign(uint8_t* msg, uint32_t end, uint64_t replay) const
+{
+    uint8_t* opt = msg + end;
+    opt[0] = OPTION_CODE;
+    opt[1] = OPTION_LEN;
+    opt[2] = 1; // protocol: delayed authentication
+    opt[3] = 1; // algorithm: HMAC-MD5
+    opt[4] = 0; // replay detection: monotonically increasing counter
+    for (int i = 0; i < 8; ++i)
+    {
+        opt[AUTH_REPLAY + i] = (replay >> (56 - 8 * i)) & 0xFF;
+    }
+    opt[AUTH_SECRET_ID] = (m_secretId >> 24) & 0xFF;
+    opt[AUTH_SECRET_ID + 1] = (m_secretId >> 16) & 0xFF;
+    opt[AUTH_SECRET_ID + 2] = (m_secretId >> 8) & 0xFF;
+    opt[AUTH_SECRET_ID + 3] = m_secretId & 0xFF;
+    memset(opt + AUTH_HMAC, 0, 16);
+    opt[2 + OPTION_LEN] = 255;
+    uint32_t len = end + OPTION_LEN + 3;
+
+    // hops and giaddr are excluded from the HMAC so relays can rewrite them
+    uint8_t hops = msg[3];
+    uint8_t giaddr[4];
+    memcpy(giaddr, msg + 24, 4);
+    msg[3] = 0;
+    memset(msg + 24, 0, 4);
+    Hmac(msg, len, opt + AUTH_HMAC);
+    msg[3] = hops;
+    memcpy(msg + 24, giaddr, 4);
+    return len;
+}
+
+bool
+DhcpAuthKey::Verify(const uint8_t* msg, uint32_t len, const DhcpAuthOption& opt) const
+{
+    if (!m_set || opt.secretId != m_secretId || len > MAX_DHCP_LEN)
+    {
+        return false;
+    }
+    uint8_t copy[MAX_DHCP_LEN];
+    memcpy(copy, msg, len);
+    copy[3] = 0;
+    memset(copy + 24, 0, 4);
+    memset(copy + opt.offset + AUTH_HMAC, 0, 16);
+
+    uint8_t mac[16];
+    Hmac(copy, len, mac);
+    uint8_t diff = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        diff |= mac[i] ^ msg[opt.offset + AUTH_HMAC + i];
+    }
+    return diff == 0;
+}
+
+bool
+DhcpAuthKey::FindOption(const uint8_t* msg, uint32_t len, DhcpAuthOption& opt)
+{
+    for (uint32_t i = 240; i + 1 < len;)
+    {
+        uint8_t code = msg[i];
+        if (code == 255)
+        {
+            break;
+        }
+        if (code == 0)
+        {
+            ++i;
+            continue;
+        }
+        uint8_t optLen = msg[i + 1];
+        if (i + 2 + optLen > len)
+        {
+            break;
+        }
+        if (code == OPTION_CODE && optLen == OPTION_LEN && msg[i + 2] == 1 && msg[i + 3] == 1 &&
+            msg[i + 4] == 0)
+        {
+            opt.offset = i;
+            opt.replay = 0;
+            for (int j = 0; j < 8; ++j)
+            {
+                opt.replay = (opt.replay << 8) | msg[i + AUTH_REPLAY + j];
+            }
+            opt.secretId = ((uint32_t)msg[i + AUTH_SECRET_ID] << 24) | (msg[i + AUTH_SECRET_ID + 1] << 16) |
+                           (msg[i + AUTH_SECRET_ID + 2] << 8) | msg[i + AUTH_SECRET_ID + 3];
+            return true;
+        }
+        i += 2 + optLen;
+    }
+    return false;
+}
+
+} // namespace ns3
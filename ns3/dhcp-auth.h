@@ -0,0 +1,84 @@
+/* dhcp-auth.h */
+
+#ifndef DHCP_AUTH_H
+#define DHCP_AUTH_H
+
+#include <cstdint>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Minimal MD5 (RFC 1321). Copyable, so a state that has already absorbed
+ * some input can be cloned and continued.
+ */
+class DhcpMd5
+{
+  public:
+    DhcpMd5();
+    void Update(const uint8_t* data, uint32_t len);
+    void Final(uint8_t digest[16]);
+
+  private:
+    void Transform(const uint8_t block[64]);
+
+    uint32_t m_state[4];
+    uint64_t m_bytes;
+    uint8_t m_buf[64];
+};
+
+/**
+ * Location and fixed fields of an RFC 3118 authentication option (code 90,
+ * delayed authentication, HMAC-MD5, monotonic replay counter).
+ */
+struct DhcpAuthOption
+{
+    uint32_t offset; // of the option code byte
+    uint64_t replay;
+    uint32_t secretId;
+};
+
+/**
+ * Per-server HMAC-MD5 key for RFC 3118-style delayed authentication.
+ *
+ * The key pads are hashed once at construction and the resulting inner and
+ * outer MD5 states are cloned per message, so signing or verifying costs
+ * only the message blocks plus one outer block.
+ */
+class DhcpAuthKey
+{
+  public:
+    static const uint8_t OPTION_CODE = 90;
+    static const uint8_t OPTION_LEN = 31; // proto, alg, rdm, replay(8), secret id(4), hmac(16)
+
+    DhcpAuthKey();
+    DhcpAuthKey(uint32_t secretId, const std::string& secret);
+
+    bool IsSet() const;
+    uint32_t GetSecretId() const;
+
+    // Insert the option at `end` (where the end option sits), re-terminate
+    // and sign. The buffer needs OPTION_LEN + 2 spare bytes; returns the new length.
+    uint32_t Sign(uint8_t* msg, uint32_t end, uint64_t replay) const;
+    bool Verify(const uint8_t* msg, uint32_t len, const DhcpAuthOption& opt) const;
+
+    void Hmac(const uint8_t* msg, uint32_t len, uint8_t mac[16]) const;
+    // Textbook HMAC that rehashes the key pads every call (benchmark baseline)
+    static void HmacUncached(const std::string& secret,
+                             const uint8_t* msg,
+                             uint32_t len,
+                             uint8_t mac[16]);
+
+    static bool FindOption(const uint8_t* msg, uint32_t len, DhcpAuthOption& opt);
+
+  private:
+    bool m_set;
+    uint32_t m_secretId;
+    DhcpMd5 m_inner; // state after (K ^ ipad)
+    DhcpMd5 m_outer; // state after (K ^ opad)
+};
+
+} // namespace ns3
+
+#endif // DHCP_AUTH_H
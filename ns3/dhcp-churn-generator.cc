@@ -0,0 +1,176 @@
+/* dhcp-churn-generator.cc */
+
+#include "dhcp-churn-generator.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DhcpChurnGenerator");
+NS_OBJECT_ENSURE_REGISTERED(DhcpChurnGenerator);
+
+TypeId
+DhcpChurnGenerator::GetTypeId(void)
+{
+    static TypeId tid = TypeId("ns3::DhcpChurnGenerator")
+                            .SetParent<Object>()
+                            .SetGroupName("Applications")
+                            .AddConstructor<DhcpChurnGenerator>();
+    return tid;
+}
+
+static Ptr<RandomVariableStream>
+MakeExponential(double mean)
+{
+    Ptr<ExponentialRandomVariable> rv = CreateObject<ExponentialRandomVariable>();
+    rv->SetAttribute("Mean", DoubleValue(mean));
+    return rv;
+}
+
+DhcpChurnGenerator::DhcpChurnGenerator()
+    : m_interArrival(MakeExponential(0.2)),
+      m_sessionLength(MakeExponential(5.0)),
+      m_offTime(MakeExponential(1.0)),
+      m_coin(CreateObject<UniformRandomVariable>()),
+      m_rejoinProbability(0.7),
+      m_arrivals(0),
+      m_rejoins(0),
+      m_departures(0)
+{
+}
+
+DhcpChurnGenerator::~DhcpChurnGenerator()
+{
+}
+
+void
+DhcpChurnGenerator::SetArrivalStream(Ptr<RandomVariableStream> interArrival)
+{
+    m_interArrival = interArrival;
+}
+
+void
+DhcpChurnGenerator::SetSessionStream(Ptr<RandomVariableStream> sessionLength)
+{
+    m_sessionLength = sessionLength;
+}
+
+void
+DhcpChurnGenerator::SetOffStream(Ptr<RandomVariableStream> offTime)
+{
+    m_offTime = offTime;
+}
+
+void
+DhcpChurnGenerator::SetRejoinProbability(double probability)
+{
+    m_rejoinProbability = probability;
+}
+
+void
+DhcpChurnGenerator::AddClient(Ptr<DhcpClientApp> client)
+{
+    client->SetManualJoin(true);
+    m_idle.push_back(client);
+}
+
+void
+DhcpChurnGenerator::Start(Time start, Time stop)
+{
+    m_stop = stop;
+    Simulator::Schedule(start, &DhcpChurnGenerator::Arrive, this);
+}
+
+uint32_t
+DhcpChurnGenerator::GetArrivals() const
+{
+    return m_arrivals;
+}
+
+uint32_t
+DhcpChurnGenerator::GetRejoins() const
+{
+    return m_rejoins;
+}
+
+uint32_t
+DhcpChurnGenerator::GetDepartures() const
+{
+    return m_departures;
+}
+
+void
+DhcpChurnGenerator::Arrive()
+{
+    if (Simulator::Now() >= m_stop)
+    {
+        return;
+    }
+    if (!m_idle.empty() && !m_idle.front()->IsRunning())
+    {
+        NS_LOG_INFO("Churn arrival dropped: client application is not running");
+    }
+    else if (!m_idle.empty())
+    {
+        Ptr<DhcpClientApp> client = m_idle.front();
+        m_idle.pop_front();
+        ++m_arrivals;
+        StartSession(client);
+    }
+    else
+    {
+        NS_LOG_INFO("Churn arrival dropped: every client is already online");
+    }
+    Simulator::Schedule(Seconds(m_interArrival->GetValue()), &DhcpChurnGenerator::Arrive, this);
+}
+
+void
+DhcpChurnGenerator::StartSession(Ptr<DhcpClientApp> client)
+{
+    client->Join();
+    Simulator::Schedule(Seconds(m_sessionLength->GetValue()),
+                        &DhcpChurnGenerator::EndSession,
+                        this,
+                        client);
+}
+
+void
+DhcpChurnGenerator::EndSession(Ptr<DhcpClientApp> client)
+{
+    if (!client->IsRunning())
+    {
+        return; // the application stopped first and already ended the session
+    }
+    ++m_departures;
+    if (Simulator::Now() < m_stop && m_coin->GetValue() < m_rejoinProbability)
+    {
+        // Temporary disconnect: keep the lease and come back with INIT-REBOOT
+        client->Leave(false);
+        Simulator::Schedule(Seconds(m_offTime->GetValue()),
+                            &DhcpChurnGenerator::Rejoin,
+                            this,
+                            client);
+    }
+    else
+    {
+        client->Leave(true);
+        m_idle.push_back(client);
+    }
+}
+
+void
+DhcpChurnGenerator::Rejoin(Ptr<DhcpClientApp> client)
+{
+    if (Simulator::Now() >= m_stop || !client->IsRunning())
+    {
+        m_idle.push_back(client);
+        return;
+    }
+    ++m_rejoins;
+    StartSession(client);
+}
+
+} // namespace ns3
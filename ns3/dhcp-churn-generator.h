@@ -0,0 +1,68 @@
+/* dhcp-churn-generator.h */
+
+#ifndef DHCP_CHURN_GENERATOR_H
+#define DHCP_CHURN_GENERATOR_H
+
+#include "dhcp-client-app.h"
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/random-variable-stream.h"
+
+#include <deque>
+
+namespace ns3
+{
+
+/**
+ * Drives a set of manual-join DhcpClientApps through continuous sessions.
+ *
+ * New clients arrive with the inter-arrival distribution and stay for a
+ * session-length draw. On departure a client either reconnects after an
+ * off-time draw (keeping its lease, so it rejoins with INIT-REBOOT) or
+ * leaves for good, releasing its lease and going back to the idle pool
+ * from which future arrivals are drawn.
+ */
+class DhcpChurnGenerator : public Object
+{
+  public:
+    static TypeId GetTypeId(void);
+    DhcpChurnGenerator();
+    virtual ~DhcpChurnGenerator();
+
+    void SetArrivalStream(Ptr<RandomVariableStream> interArrival); // seconds
+    void SetSessionStream(Ptr<RandomVariableStream> sessionLength); // seconds
+    void SetOffStream(Ptr<RandomVariableStream> offTime);           // seconds
+    void SetRejoinProbability(double probability);
+
+    void AddClient(Ptr<DhcpClientApp> client);
+    void Start(Time start, Time stop);
+
+    uint32_t GetArrivals() const;
+    uint32_t GetRejoins() const;
+    uint32_t GetDepartures() const;
+
+  private:
+    void Arrive();
+    void StartSession(Ptr<DhcpClientApp> client);
+    void EndSession(Ptr<DhcpClientApp> client);
+    void Rejoin(Ptr<DhcpClientApp> client);
+
+    Ptr<RandomVariableStream> m_interArrival;
+    Ptr<RandomVariableStream> m_sessionLength;
+    Ptr<RandomVariableStream> m_offTime;
+    Ptr<UniformRandomVariable> m_coin;
+    double m_rejoinProbability;
+
+    std::deque<Ptr<DhcpClientApp>> m_idle; // clients not currently on the network
+    Time m_stop;
+
+    uint32_t m_arrivals;
+    uint32_t m_rejoins;
+    uint32_t m_departures;
+};
+
+} // namespace ns3
+
+#endif // DHCP_CHURN_GENERATOR_H
@@ -10,6 +10,7 @@
 #include "ns3/simulator.h"
 #include "ns3/udp-socket-factory.h"
 
+#include <algorithm>
 #include <iomanip> // Required for std::setw and std::setfill
 
 namespace ns3
@@ -20,6 +21,16 @@ NS_OBJECT_ENSURE_REGISTERED(DhcpClientApp);
 
 int DhcpClientApp::s_rogueAssigned = 0;
 int DhcpClientApp::s_legitAssigned = 0;
+int DhcpClientApp::s_rogueLeases = 0;
+int DhcpClientApp::s_legitLeases = 0;
+int DhcpClientApp::s_legitOffers = 0;
+Time DhcpClientApp::s_legitOfferLatency;
+std::set<Ipv4Address> DhcpClientApp::s_legitServers;
+std::set<Ipv4Address> DhcpClientApp::s_rogueServers;
+int DhcpClientApp::s_discoverJoins = 0;
+Time DhcpClientApp::s_discoverJoinLatency;
+int DhcpClientApp::s_reboots = 0;
+Time DhcpClientApp::s_rebootLatency;
 
 TypeId
 DhcpClientApp::GetTypeId(void)
@@ -44,6 +55,30 @@ DhcpClientApp::~DhcpClientApp()
     m_socket = nullptr;
 }
 
+void
+DhcpClientApp::AddLegitServer(Ipv4Address serverIp)
+{
+    s_legitServers.insert(serverIp);
+}
+
+void
+DhcpClientApp::AddRogueServer(Ipv4Address serverIp)
+{
+    s_rogueServers.insert(serverIp);
+}
+
+bool
+DhcpClientApp::IsLegitServer(Ipv4Address serverIp)
+{
+    return s_legitServers.find(serverIp) != s_legitServers.end();
+}
+
+bool
+DhcpClientApp::IsRogueServer(Ipv4Address serverIp)
+{
+    return s_rogueServers.find(serverIp) != s_rogueServers.end();
+}
+
 void
 DhcpClientApp::Setup(Address broadcastAddress, uint16_t port)
 {
@@ -109,18 +144,22 @@ DhcpClientApp::StartApplication()
                                 i);
         }
     }
-    else
+    else if (!m_manualJoin)
     {
-        Simulator::Schedule(Seconds(1.0), &DhcpClientApp::SendDiscover, this);
+        Simulator::Schedule(Seconds(1.0), &DhcpClientApp::Join, this);
     }
 }
 
 void
 DhcpClientApp::StopApplication()
 {
+    Simulator::Cancel(m_rebootEvent);
+    m_active = false;
+    m_rebooting = false;
     if (m_socket)
     {
         m_socket->Close();
+        m_socket = nullptr;
     }
 }
 
@@ -129,9 +168,84 @@ DhcpClientApp::SendDiscover()
 {
     Ptr<Packet> packet = BuildDhcpDiscoverPacket();
     m_socket->SendTo(packet, 0, InetSocketAddress(Ipv4Address("255.255.255.255"), m_port));
+    m_discoverTime = Simulator::Now();
     NS_LOG_INFO("Client sent DHCPDISCOVER with XID=" << m_xid);
 }
 
+void
+DhcpClientApp::Join()
+{
+    if (!m_socket)
+    {
+        NS_LOG_INFO("Join ignored: client is not running");
+        return;
+    }
+    if (m_sessions++ > 0)
+    {
+        m_xid = rand(); // fresh transaction for every new session
+    }
+    m_active = true;
+    m_receivedOffer = false;
+    m_legitOfferSeen = false;
+    m_joinTime = Simulator::Now();
+
+    if (m_initRebootEnabled && m_hasLease)
+    {
+        SendInitReboot();
+    }
+    else
+    {
+        SendDiscover();
+    }
+}
+
+void
+DhcpClientApp::Leave(bool release)
+{
+    Simulator::Cancel(m_rebootEvent);
+    m_active = false;
+    m_rebooting = false;
+
+    if (release && m_hasLease && m_socket)
+    {
+        m_socket->SendTo(BuildDhcpReleasePacket(m_lastLease), 0, m_serverAddress);
+        m_hasLease = false;
+        NS_LOG_INFO("Client released " << m_lastLease);
+    }
+}
+
+bool
+DhcpClientApp::HasLease() const
+{
+    return m_hasLease;
+}
+
+bool
+DhcpClientApp::IsRunning() const
+{
+    return bool(m_socket);
+}
+
+void
+DhcpClientApp::SendInitReboot()
+{
+    m_rebooting = true;
+    Ptr<Packet> packet = BuildDhcpRequestPacket(m_lastLease);
+    m_socket->SendTo(packet, 0, InetSocketAddress(Ipv4Address("255.255.255.255"), m_port));
+    m_rebootEvent = Simulator::Schedule(m_rebootTimeout, &DhcpClientApp::RebootFailed, this);
+    NS_LOG_INFO("Client sent INIT-REBOOT DHCPREQUEST for " << m_lastLease << " XID=" << m_xid);
+}
+
+void
+DhcpClientApp::RebootFailed()
+{
+    Simulator::Cancel(m_rebootEvent);
+    m_rebooting = false;
+    m_hasLease = false;
+    NS_LOG_INFO("INIT-REBOOT for " << m_lastLease << " failed, falling back to DISCOVER");
+    SendDiscover();
+}
+
 void
 DhcpClientApp::HandleRead(Ptr<Socket> socket)
 {
@@ -161,8 +275,8 @@ DhcpClientApp::HandleRead(Ptr<Socket> socket)
     }
 
     uint32_t xid = (data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
-    if (xid != m_xid)
-        return; // Ignore packets for other clients
+    if (xid != m_xid || !m_active)
+        return; // Ignore packets for other clients or outside a session
 
     Ipv4Address serverIp = InetSocketAddress::ConvertFrom(from).GetIpv4(); 
 
@@ -172,10 +286,40 @@ DhcpClientApp::HandleRead(Ptr<Socket> socket)
         return; // Ignore packets from untrusted servers
     }
 
+    if (m_authEnabled)
+    {
+        DhcpAuthOption auth;
+        uint32_t len = std::min<uint32_t>(packet->GetSize(), sizeof(data));
+        if (!DhcpAuthKey::FindOption(data, len, auth))
+        {
+            NS_LOG_INFO("Dropped unauthenticated packet from " << serverIp);
+            return;
+        }
+        auto key = m_serverKeys.find(auth.secretId);
+        if (key == m_serverKeys.end() || !key->second.Verify(data, len, auth))
+        {
+            NS_LOG_INFO("Dropped packet with bad HMAC from " << serverIp);
+            return;
+        }
+        if (auth.replay <= m_lastReplay[auth.secretId])
+        {
+            NS_LOG_INFO("Dropped replayed packet from " << serverIp);
+            return;
+        }
+        m_lastReplay[auth.secretId] = auth.replay;
+    }
+
     Ipv4Address offeredIp =
         Ipv4Address((data[16] << 24) | (data[17] << 16) | (data[18] << 8) | data[19]);
 
-    if (msgType == 2 && !m_receivedOffer)
+    if (msgType == 2 && !m_legitOfferSeen && IsLegitServer(serverIp))
+    {
+        m_legitOfferSeen = true;
+        ++s_legitOffers;
+        s_legitOfferLatency += Simulator::Now() - m_discoverTime;
+    }
+
+    if (msgType == 2 && !m_receivedOffer && !m_rebooting)
     { // OFFER
         m_receivedOffer = true;
         m_serverAddress = from;
@@ -189,16 +333,43 @@ DhcpClientApp::HandleRead(Ptr<Socket> socket)
     }
     else if (msgType == 5)
     { // DHCPACK
+        if (m_rebooting)
+        {
+            m_serverAddress = from; // no OFFER in INIT-REBOOT
+            ++s_reboots;
+            s_rebootLatency += Simulator::Now() - m_joinTime;
+        }
+        else
+        {
+            ++s_discoverJoins;
+            s_discoverJoinLatency += Simulator::Now() - m_joinTime;
+        }
+        Simulator::Cancel(m_rebootEvent);
+        m_rebooting = false;
         m_assignedIp = offeredIp;
+        m_lastLease = offeredIp;
+        m_hasLease = true;
         Ipv4Address serverIp = InetSocketAddress::ConvertFrom(m_serverAddress).GetIpv4();
 
-        if (serverIp == Ipv4Address("10.1.1.142"))
-            ++s_rogueAssigned;
-        else if (serverIp == Ipv4Address("10.1.1.141"))
-            ++s_legitAssigned;
+        bool rogue = IsRogueServer(serverIp);
+        bool legit = !rogue && IsLegitServer(serverIp);
+        s_rogueLeases += rogue;
+        s_legitLeases += legit;
+        if (!m_counted && (rogue || legit))
+        {
+            m_counted = true;
+            if (rogue)
+                ++s_rogueAssigned;
+            else
+                ++s_legitAssigned;
+        }
 
         NS_LOG_INFO("Client got IP " << offeredIp << " from " << serverIp);
     }
+    else if (msgType == 6 && m_rebooting)
+    { // DHCPNAK
+        RebootFailed();
+    }
 }
 
 Ptr<Packet>
@@ -275,6 +446,43 @@ DhcpClientApp::BuildDhcpRequestPacket(Ipv4Address requestedIp)
     return Create<Packet>(buf, 250);
 }
 
+Ptr<Packet>
+DhcpClientApp::BuildDhcpReleasePacket(Ipv4Address clientIp)
+{
+    uint8_t buf[300] = {0};
+    buf[0] = 1;
+    buf[1] = 1;
+    buf[2] = 6;
+    buf[3] = 0;
+
+    buf[4] = (m_xid >> 24) & 0xFF;
+    buf[5] = (m_xid >> 16) & 0xFF;
+    buf[6] = (m_xid >> 8) & 0xFF;
+    buf[7] = m_xid & 0xFF;
+
+    // ciaddr: the address being released
+    uint32_t ip = clientIp.Get();
+    buf[12] = (ip >> 24) & 0xFF;
+    buf[13] = (ip >> 16) & 0xFF;
+    buf[14] = (ip >> 8) & 0xFF;
+    buf[15] = ip & 0xFF;
+
+    buf[236] = 99;
+    buf[237] = 130;
+    buf[238] = 83;
+    buf[239] = 99;
+
+    // DHCP option 53: DHCPRELEASE
+    buf[240] = 53;
+    buf[241] = 1;
+    buf[242] = 7;
+    buf[243] = 255;
+
+    m_mac.CopyTo(&buf[28]);
+
+    return Create<Packet>(buf, 244);
+}
+
 void
 DhcpClientApp::SetIsAttacker(bool isAttacker)
 {
@@ -321,6 +529,30 @@ DhcpClientApp::EnableSpoofingDefense(bool enable)
     m_spoofingDefenseEnabled = enable;
 }
 
+void
+DhcpClientApp::AddServerKey(uint32_t secretId, std::string secret)
+{
+    m_serverKeys[secretId] = DhcpAuthKey(secretId, secret);
+}
+
+void
+DhcpClientApp::EnableAuthentication(bool enable)
+{
+    m_authEnabled = enable;
+}
+
+void
+DhcpClientApp::SetManualJoin(bool manual)
+{
+    m_manualJoin = manual;
+}
+
+void
+DhcpClientApp::EnableInitReboot(bool enable)
+{
+    m_initRebootEnabled = enable;
+}
+
 
 
 } // namespace ns3
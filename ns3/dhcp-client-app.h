@@ -3,21 +3,42 @@
 #ifndef DHCP_CLIENT_APP_H
 #define DHCP_CLIENT_APP_H
 
+#include "dhcp-auth.h"
+
 #include "ns3/address.h"
 #include "ns3/application.h"
+#include "ns3/event-id.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
 #include "ns3/ptr.h"
 #include "ns3/socket.h"
 
+#include <map>
+#include <set>
+
 namespace ns3
 {
 
 class DhcpClientApp : public Application
 {
   public:
-    static int s_rogueAssigned;
+    static int s_rogueAssigned; // clients, counted once by their first lease
     static int s_legitAssigned;
+    static int s_rogueLeases; // every ACK, so churn sessions count separately
+    static int s_legitLeases;
+    static int s_legitOffers;
+    static Time s_legitOfferLatency; // sum of DISCOVER -> legit OFFER delays
+
+    // Which server addresses count as legit or rogue in the statistics
+    static void AddLegitServer(Ipv4Address serverIp);
+    static void AddRogueServer(Ipv4Address serverIp);
+
+    // Join latency split by how the client (re)joined
+    static int s_discoverJoins;
+    static Time s_discoverJoinLatency; // sum of Join -> ACK delays via DISCOVER
+    static int s_reboots;
+    static Time s_rebootLatency; // sum of Join -> ACK delays via INIT-REBOOT
 
     static TypeId GetTypeId(void);
     DhcpClientApp();
@@ -34,16 +55,38 @@ class DhcpClientApp : public Application
     void AddTrustedServer(Ipv4Address serverIp);
     void EnableSpoofingDefense(bool enable);
 
+    // RFC 3118-style defense: only accept replies carrying a valid HMAC from
+    // a known server key with a fresh replay counter.
+    void AddServerKey(uint32_t secretId, std::string secret);
+    void EnableAuthentication(bool enable);
+
+    // Session control for churn workloads: with manual join the client waits
+    // for Join(); with INIT-REBOOT it re-requests its last lease on rejoin.
+    void SetManualJoin(bool manual);
+    void EnableInitReboot(bool enable);
+    void Join();
+    void Leave(bool release);
+    bool HasLease() const;
+    bool IsRunning() const; // between StartApplication and StopApplication
+
   protected:
     virtual void StartApplication(void);
     virtual void StopApplication(void);
 
   private:
+    static bool IsLegitServer(Ipv4Address serverIp);
+    static bool IsRogueServer(Ipv4Address serverIp);
+    static std::set<Ipv4Address> s_legitServers;
+    static std::set<Ipv4Address> s_rogueServers;
+
     void SendDiscover();                 // Send DHCPDISCOVER
+    void SendInitReboot();               // Send DHCPREQUEST for the remembered lease
+    void RebootFailed();                 // NAK or no reply: fall back to DISCOVER
     void HandleRead(Ptr<Socket> socket); // Handle OFFER or ACK
 
     Ptr<Packet> BuildDhcpDiscoverPacket();
     Ptr<Packet> BuildDhcpRequestPacket(Ipv4Address requestedIp);
+    Ptr<Packet> BuildDhcpReleasePacket(Ipv4Address clientIp);
 
     Ptr<Socket> m_socket;
     Address m_broadcastAddress;
@@ -51,6 +94,8 @@ class DhcpClientApp : public Application
     Ipv4Address m_assignedIp;
     uint16_t m_port;
     bool m_receivedOffer;
+    bool m_legitOfferSeen = false;
+    Time m_discoverTime;
 
     uint32_t m_xid;     // Transaction ID
     Mac48Address m_mac; // Client MAC address
@@ -63,6 +108,23 @@ class DhcpClientApp : public Application
 
     std::set<Ipv4Address> m_whiteListedServers; // List of legitimate DHCP servers
     bool m_spoofingDefenseEnabled = false; // Flag to enable/disable spoofing defense
+
+    bool m_authEnabled = false;
+    std::map<uint32_t, DhcpAuthKey> m_serverKeys; // secret ID -> key
+    std::map<uint32_t, uint64_t> m_lastReplay;    // secret ID -> highest counter seen
+
+    // Churn / INIT-REBOOT state
+    bool m_manualJoin = false;
+    bool m_initRebootEnabled = false;
+    bool m_active = false;    // inside a session
+    bool m_rebooting = false; // INIT-REBOOT request outstanding
+    bool m_hasLease = false;  // m_lastLease is valid
+    bool m_counted = false;   // already in s_rogueAssigned / s_legitAssigned
+    Ipv4Address m_lastLease;
+    uint32_t m_sessions = 0;
+    Time m_joinTime;
+    Time m_rebootTimeout = MilliSeconds(500);
+    EventId m_rebootEvent;
 };
 
 } // namespace ns3
@@ -0,0 +1,185 @@
+// dhcp-flood-gen.cc
+//
+// Local DISCOVER load generator for dhcp-emu-sim. Sends DHCPDISCOVERs with a
+// unique chaddr/xid each in sendmmsg batches at a fixed rate and collects the
+// OFFERs with recvmmsg, reporting OFFER rate and latency. Plain POSIX, no ns-3
+// dependencies; run it in the generator namespace set up by dhcp-emu.sh.
+//
+//   dhcp-flood-gen -i veth-gen -r 20000 -d 10 -b 64
+
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+static const uint32_t MAX_BATCH = 256;
+static const uint32_t DHCP_LEN = 244;
+
+static uint64_t NowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void BuildDiscover(uint8_t *buf, uint32_t seq) {
+  memset(buf, 0, DHCP_LEN);
+  buf[0] = 1; buf[1] = 1; buf[2] = 6; buf[3] = 0;
+  // xid carries the sequence number so OFFERs can be matched to send times
+  buf[4] = (seq >> 24) & 0xFF;
+  buf[5] = (seq >> 16) & 0xFF;
+  buf[6] = (seq >> 8) & 0xFF;
+  buf[7] = seq & 0xFF;
+  // Locally administered chaddr, unique per DISCOVER
+  buf[28] = 0x02; buf[29] = 0x00;
+  buf[30] = (seq >> 24) & 0xFF;
+  buf[31] = (seq >> 16) & 0xFF;
+  buf[32] = (seq >> 8) & 0xFF;
+  buf[33] = seq & 0xFF;
+  buf[236] = 99; buf[237] = 130; buf[238] = 83; buf[239] = 99;
+  buf[240] = 53; buf[241] = 1; buf[242] = 1; // DHCPDISCOVER
+  buf[243] = 255;
+}
+
+static void Usage(const char *prog) {
+  fprintf(stderr, "usage: %s -i iface [-r rate/s] [-d seconds] [-b batch]\n", prog);
+  exit(1);
+}
+
+int main(int argc, char *argv[]) {
+  const char *iface = nullptr;
+  uint32_t rate = 20000;
+  double duration = 10.0;
+  uint32_t batch = 64;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "i:r:d:b:")) != -1) {
+    switch (opt) {
+      case 'i': iface = optarg; break;
+      case 'r': rate = strtoul(optarg, nullptr, 10); break;
+      case 'd': duration = atof(optarg); break;
+      case 'b': batch = strtoul(optarg, nullptr, 10); break;
+      default: Usage(argv[0]);
+    }
+  }
+  if (!iface || rate == 0 || batch == 0 || batch > MAX_BATCH) Usage(argv[0]);
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  int on = 1;
+  timeval tv = {0, 100000}; // lets the receiver notice the end of the run
+  sockaddr_in local = {};
+  local.sin_family = AF_INET;
+  local.sin_port = htons(68);
+  local.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (fd < 0 ||
+      setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on)) != 0 ||
+      setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+      setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, iface, strlen(iface)) != 0 ||
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0 ||
+      bind(fd, (sockaddr *) &local, sizeof(local)) != 0) {
+    fprintf(stderr, "socket setup on %s failed: %s\n", iface, strerror(errno));
+    return 1;
+  }
+
+  uint32_t total = (uint32_t) (rate * duration);
+  std::vector<std::atomic<uint64_t>> sendNs(total); // written by sender, read by receiver
+  std::atomic<bool> done(false);
+  std::atomic<uint32_t> offers(0);
+  uint64_t latencySumNs = 0, latencyMaxNs = 0;
+
+  // Receiver: drain OFFERs in recvmmsg batches and match them by xid
+  std::thread receiver([&]() {
+    static uint8_t bufs[MAX_BATCH][300];
+    iovec iov[MAX_BATCH];
+    mmsghdr msgs[MAX_BATCH];
+    for (uint32_t i = 0; i < MAX_BATCH; ++i) {
+      iov[i].iov_base = bufs[i];
+      iov[i].iov_len = sizeof(bufs[i]);
+      memset(&msgs[i], 0, sizeof(msgs[i]));
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    while (!done) {
+      int n = recvmmsg(fd, msgs, MAX_BATCH, MSG_WAITFORONE, nullptr);
+      if (n <= 0) continue;
+      uint64_t now = NowNs();
+      for (int i = 0; i < n; ++i) {
+        const uint8_t *d = bufs[i];
+        if (msgs[i].msg_len < DHCP_LEN || d[0] != 2 || d[240] != 53 || d[242] != 2) continue;
+        uint32_t xid = (d[4] << 24) | (d[5] << 16) | (d[6] << 8) | d[7];
+        if (xid >= total) continue;
+        uint64_t sentAt = sendNs[xid].load(std::memory_order_relaxed);
+        if (sentAt == 0) continue;
+        uint64_t lat = now - sentAt;
+        latencySumNs += lat;
+        latencyMaxNs = std::max(latencyMaxNs, lat);
+        offers++;
+      }
+    }
+  });
+
+  sockaddr_in dst = {};
+  dst.sin_family = AF_INET;
+  dst.sin_port = htons(67);
+  dst.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+
+  static uint8_t bufs[MAX_BATCH][DHCP_LEN];
+  iovec iov[MAX_BATCH];
+  mmsghdr msgs[MAX_BATCH];
+  for (uint32_t i = 0; i < batch; ++i) {
+    iov[i].iov_base = bufs[i];
+    iov[i].iov_len = DHCP_LEN;
+    memset(&msgs[i], 0, sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = &dst;
+    msgs[i].msg_hdr.msg_namelen = sizeof(dst);
+  }
+
+  // Sender: one sendmmsg batch per tick, ticks paced on absolute deadlines
+  uint64_t tickNs = (uint64_t) batch * 1000000000ull / rate;
+  uint64_t start = NowNs(), next = start;
+  uint32_t sent = 0;
+  while (sent < total) {
+    uint32_t n = std::min(batch, total - sent);
+    for (uint32_t i = 0; i < n; ++i) BuildDiscover(bufs[i], sent + i);
+    uint64_t now = NowNs();
+    for (uint32_t i = 0; i < n; ++i) sendNs[sent + i].store(now, std::memory_order_relaxed);
+    int r = sendmmsg(fd, msgs, n, 0);
+    if (r < 0) {
+      fprintf(stderr, "sendmmsg failed: %s\n", strerror(errno));
+      break;
+    }
+    sent += r;
+
+    next += tickNs;
+    timespec ts = {(time_t) (next / 1000000000ull), (long) (next % 1000000000ull)};
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+  }
+  double elapsed = (NowNs() - start) / 1e9;
+
+  sleep(1); // let the last OFFERs arrive
+  done = true;
+  receiver.join();
+  close(fd);
+
+  uint32_t got = offers;
+  printf("========= DHCP Flood Generator =========\n");
+  printf("DISCOVERs sent : %u (%.0f /s, batch %u)\n", sent, sent / elapsed, batch);
+  printf("OFFERs received: %u (%.1f%%)\n", got, sent > 0 ? 100.0 * got / sent : 0);
+  printf("OFFER latency  : avg %.3f ms, max %.3f ms\n",
+         got > 0 ? latencySumNs / 1e6 / got : 0, latencyMaxNs / 1e6);
+  printf("========================================\n");
+  return 0;
+}
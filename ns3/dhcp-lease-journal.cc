@@ -0,0 +1,241 @@
+/* dhcp-lease-journal.cc */
+
+#include "dhcp-lease-journal.h"
+
+#include "ns3/log.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DhcpLeaseJournal");
+
+static const uint32_t JOURNAL_MAGIC = 0x444c4a31; // "DLJ1"
+static const uint32_t JOURNAL_VERSION = 1;
+
+static_assert(sizeof(DhcpLeaseJournal::Record) == 16, "journal records must stay fixed-size");
+
+DhcpLeaseJournal::DhcpLeaseJournal()
+    : m_fd(-1),
+      m_header(nullptr),
+      m_mapLen(0)
+{
+}
+
+DhcpLeaseJournal::~DhcpLeaseJournal()
+{
+    Close();
+}
+
+bool
+DhcpLeaseJournal::Open(const std::string& path, uint32_t initialCapacity)
+{
+    Close();
+    m_fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_fd < 0)
+    {
+        NS_LOG_WARN("Cannot open lease journal " << path << ": " << strerror(errno));
+        return false;
+    }
+
+    Header hdr;
+    struct stat st;
+    bool valid = fstat(m_fd, &st) == 0 && (size_t)st.st_size >= sizeof(Header) &&
+                 pread(m_fd, &hdr, sizeof(hdr), 0) == (ssize_t)sizeof(hdr) &&
+                 hdr.magic == JOURNAL_MAGIC && hdr.version == JOURNAL_VERSION &&
+                 hdr.count <= hdr.capacity &&
+                 (size_t)st.st_size >= sizeof(Header) + (size_t)hdr.capacity * sizeof(Record);
+
+    if (!Map(valid ? hdr.capacity : initialCapacity))
+    {
+        Close();
+        return false;
+    }
+    if (!valid)
+    {
+        m_header->magic = JOURNAL_MAGIC;
+        m_header->version = JOURNAL_VERSION;
+        m_header->count = 0;
+        NS_LOG_INFO("Created lease journal " << path);
+    }
+    else
+    {
+        NS_LOG_INFO("Opened lease journal " << path << " with " << m_header->count << " records");
+    }
+    return true;
+}
+
+void
+DhcpLeaseJournal::Close()
+{
+    Unmap();
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool
+DhcpLeaseJournal::IsOpen() const
+{
+    return m_header != nullptr;
+}
+
+bool
+DhcpLeaseJournal::Map(uint32_t capacity)
+{
+    // Append relies on room for at least one record after compaction
+    if (capacity == 0)
+    {
+        capacity = 1;
+    }
+    size_t len = sizeof(Header) + (size_t)capacity * sizeof(Record);
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || ((size_t)st.st_size < len && ftruncate(m_fd, len) != 0))
+    {
+        NS_LOG_WARN("Cannot size lease journal: " << strerror(errno));
+        return false;
+    }
+    void* addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        NS_LOG_WARN("Cannot map lease journal: " << strerror(errno));
+        return false;
+    }
+    m_header = static_cast<Header*>(addr);
+    m_mapLen = len;
+    m_header->capacity = capacity;
+    return true;
+}
+
+void
+DhcpLeaseJournal::Unmap()
+{
+    if (m_header)
+    {
+        munmap(m_header, m_mapLen);
+        m_header = nullptr;
+        m_mapLen = 0;
+    }
+}
+
+DhcpLeaseJournal::Record*
+DhcpLeaseJournal::Records() const
+{
+    return reinterpret_cast<Record*>(reinterpret_cast<uint8_t*>(m_header) + sizeof(Header));
+}
+
+void
+DhcpLeaseJournal::Append(Op op, Ipv4Address ip, uint32_t xid, Mac48Address chaddr)
+{
+    if (!m_header)
+    {
+        return;
+    }
+    if (m_header->count == m_header->capacity)
+    {
+        Compact();
+        // Still more than half full after compaction: grow instead of
+        // compacting again on the next few appends
+        if (m_header->count > m_header->capacity / 2 || m_header->count == m_header->capacity)
+        {
+            uint32_t count = m_header->count;
+            uint32_t capacity = m_header->capacity * 2;
+            Unmap();
+            if (!Map(capacity))
+            {
+                Close();
+                return;
+            }
+            m_header->count = count;
+        }
+    }
+
+    Record& rec = Records()[m_header->count];
+    rec.ip = ip.Get();
+    rec.xid = xid;
+    chaddr.CopyTo(rec.chaddr);
+    rec.op = op;
+    rec.reserved = 0;
+    // Publish the record only once it is fully written
+    m_header->count++;
+}
+
+std::map<uint32_t, DhcpLeaseJournal::Record>
+DhcpLeaseJournal::Recover() const
+{
+    std::map<uint32_t, Record> live;
+    if (!m_header)
+    {
+        return live;
+    }
+    const Record* recs = Records();
+    for (uint32_t i = 0; i < m_header->count; ++i)
+    {
+        if (recs[i].op == BIND)
+        {
+            live[recs[i].ip] = recs[i];
+        }
+        else if (recs[i].op == RELEASE)
+        {
+            live.erase(recs[i].ip);
+        }
+    }
+    return live;
+}
+
+void
+DhcpLeaseJournal::Compact()
+{
+    if (!m_header)
+    {
+        return;
+    }
+    std::map<uint32_t, Record> live = Recover();
+    Record* recs = Records();
+    uint32_t n = 0;
+    for (const auto& entry : live)
+    {
+        recs[n++] = entry.second;
+    }
+    NS_LOG_INFO("Compacted lease journal from " << m_header->count << " to " << n << " records");
+    m_header->count = n;
+}
+
+uint32_t
+DhcpLeaseJournal::GetRecordCount() const
+{
+    return m_header ? m_header->count : 0;
+}
+
+bool
+DhcpLeaseJournal::Generate(const std::string& path, Ipv4Address startIp, uint32_t count)
+{
+    unlink(path.c_str());
+    DhcpLeaseJournal journal;
+    if (!journal.Open(path, count > 0 ? count : 1))
+    {
+        return false;
+    }
+    uint8_t mac[6] = {0x02, 0x00, 0, 0, 0, 0}; // locally administered
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        mac[2] = (i >> 24) & 0xFF;
+        mac[3] = (i >> 16) & 0xFF;
+        mac[4] = (i >> 8) & 0xFF;
+        mac[5] = i & 0xFF;
+        Mac48Address chaddr;
+        chaddr.CopyFrom(mac);
+        journal.Append(BIND, Ipv4Address(startIp.Get() + i), i, chaddr);
+    }
+    return true;
+}
+
+} // namespace ns3
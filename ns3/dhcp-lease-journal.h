@@ -0,0 +1,80 @@
+/* dhcp-lease-journal.h */
+
+#ifndef DHCP_LEASE_JOURNAL_H
+#define DHCP_LEASE_JOURNAL_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/mac48-address.h"
+
+#include <map>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * Append-only lease journal with fixed-size records, kept in an mmap'd file.
+ *
+ * Every binding change is appended as one record; replaying the records in
+ * order yields the live lease table. When the file fills up it is compacted
+ * in place down to one record per live lease, and grown only if that is not
+ * enough. Recovery is a single sequential pass over the mapping.
+ */
+class DhcpLeaseJournal
+{
+  public:
+    enum Op : uint8_t
+    {
+        BIND = 1,
+        RELEASE = 2
+    };
+
+    struct Record
+    {
+        uint32_t ip;
+        uint32_t xid;
+        uint8_t chaddr[6];
+        uint8_t op;
+        uint8_t reserved;
+    };
+
+    DhcpLeaseJournal();
+    ~DhcpLeaseJournal();
+    DhcpLeaseJournal(const DhcpLeaseJournal&) = delete;
+    DhcpLeaseJournal& operator=(const DhcpLeaseJournal&) = delete;
+
+    bool Open(const std::string& path, uint32_t initialCapacity = 4096);
+    void Close();
+    bool IsOpen() const;
+
+    void Append(Op op, Ipv4Address ip, uint32_t xid, Mac48Address chaddr);
+    std::map<uint32_t, Record> Recover() const; // ip -> live binding
+    void Compact();
+
+    uint32_t GetRecordCount() const;
+
+    // Write a journal holding `count` bindings from `startIp` with synthetic
+    // MACs, so scenarios can start from an already-occupied pool.
+    static bool Generate(const std::string& path, Ipv4Address startIp, uint32_t count);
+
+  private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t count;
+    };
+
+    bool Map(uint32_t capacity);
+    void Unmap();
+    Record* Records() const;
+
+    int m_fd;
+    Header* m_header;
+    size_t m_mapLen;
+};
+
+} // namespace ns3
+
+#endif // DHCP_LEASE_JOURNAL_H
@@ -3,12 +3,60 @@
 #include "ns3/log.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <chrono>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("DhcpServerApp");
 NS_OBJECT_ENSURE_REGISTERED(DhcpServerApp);
 
+// Mixing table from RFC 3074 section 6 (Pearson hash)
+static const uint8_t s_loadbMxTbl[256] = {
+  251, 175, 119, 215, 81, 14, 79, 191, 103, 49, 181, 143, 186, 157, 0, 232,
+  31, 32, 55, 60, 152, 58, 17, 237, 174, 70, 160, 144, 220, 90, 57, 223,
+  59, 3, 18, 140, 111, 166, 203, 196, 134, 243, 124, 95, 222, 179, 197, 65,
+  180, 48, 36, 15, 107, 46, 233, 130, 165, 30, 123, 161, 209, 23, 97, 16,
+  40, 91, 219, 61, 100, 10, 210, 109, 250, 127, 22, 138, 29, 108, 244, 67,
+  207, 9, 178, 204, 74, 98, 126, 249, 167, 116, 34, 77, 193, 200, 121, 5,
+  20, 113, 71, 35, 128, 13, 182, 94, 25, 226, 227, 199, 75, 27, 41, 245,
+  230, 224, 43, 225, 177, 26, 155, 150, 212, 142, 218, 115, 241, 73, 88, 105,
+  39, 114, 62, 255, 192, 201, 145, 214, 168, 158, 221, 148, 154, 122, 12, 84,
+  82, 163, 44, 139, 228, 236, 205, 242, 217, 11, 187, 146, 159, 64, 86, 239,
+  195, 42, 106, 198, 118, 112, 184, 172, 87, 2, 173, 117, 176, 229, 247, 253,
+  137, 185, 99, 164, 102, 147, 45, 66, 231, 52, 141, 211, 194, 206, 246, 238,
+  56, 110, 78, 248, 63, 240, 189, 93, 92, 51, 53, 183, 19, 171, 72, 50,
+  33, 104, 101, 69, 8, 252, 83, 120, 76, 135, 85, 54, 202, 125, 188, 213,
+  96, 235, 136, 208, 162, 129, 190, 132, 156, 38, 47, 1, 7, 254, 24, 4,
+  216, 131, 89, 21, 28, 133, 37, 153, 149, 80, 170, 68, 6, 169, 234, 151
+};
+
+// Pool-sync message types exchanged between cooperating servers
+static const uint8_t SYNC_HEARTBEAT = 1;
+static const uint8_t SYNC_BNDUPD = 2;
+static const uint8_t SYNC_RELEASE = 3;
+static const uint8_t SYNC_HELLO = 4; // sender just started: send it the whole pool
+// A message is a 2-byte header (type, server index) followed by one or more
+// 10-byte (ip, chaddr) records; pool dumps pack many records per message.
+static const uint32_t SYNC_HDR_LEN = 2;
+static const uint32_t SYNC_REC_LEN = 10;
+static const uint32_t SYNC_MAX_RECORDS = 140; // keeps a dump message under one MTU
+
+// Nanosecond clock for the replay counter. Simulation time restarts at zero
+// with every emulation run, so under the real-time scheduler use wall time.
+static uint64_t AuthReplaySeed() {
+  StringValue impl;
+  GlobalValue::GetValueByName("SimulatorImplementationType", impl);
+  if (impl.Get() == "ns3::RealtimeSimulatorImpl") {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+  return Simulator::Now().GetNanoSeconds();
+}
+
 TypeId DhcpServerApp::GetTypeId(void) {
   static TypeId tid = TypeId("ns3::DhcpServerApp")
     .SetParent<Application>()
@@ -25,6 +73,8 @@ DhcpServerApp::~DhcpServerApp() {
 
 void DhcpServerApp::Setup(Ipv4Address startIp, uint32_t poolSize, uint16_t port, Time delay) {
   m_currentIp = startIp;
+  m_poolStart = startIp;
+  m_poolSize = poolSize;
   m_remaining = poolSize;
   m_port = port;
   m_delay = delay;
@@ -40,37 +90,306 @@ void DhcpServerApp::EnableDefense(bool on) {
   }
 }
 
+void DhcpServerApp::SetLoadBalancing(uint32_t serverIndex, uint32_t numServers) {
+  NS_ASSERT(numServers > 0 && serverIndex < numServers);
+  m_serverIndex = serverIndex;
+  m_numServers = numServers;
+  NS_LOG_INFO("Load balancing: server " << serverIndex << " of " << numServers);
+}
+
+void DhcpServerApp::AddPeer(uint32_t peerIndex, Ipv4Address peerIp) {
+  NS_ASSERT(peerIndex < m_numServers && peerIndex != m_serverIndex);
+  m_peers[peerIndex] = peerIp;
+}
+
+void DhcpServerApp::SetLeaseJournal(std::string path, Time compactInterval) {
+  m_journalPath = path;
+  m_journalCompactInterval = compactInterval;
+}
+
+uint32_t DhcpServerApp::GetRxCount() const {
+  return m_rxCount;
+}
+
+uint32_t DhcpServerApp::GetAllocationCount() const {
+  return m_allocCount;
+}
+
+uint32_t DhcpServerApp::GetReleaseCount() const {
+  return m_releaseCount;
+}
+
+uint32_t DhcpServerApp::GetRemaining() const {
+  return m_remaining;
+}
+
+void DhcpServerApp::EnableCostMeasurement(bool on) {
+  m_measureCost = on;
+}
+
+uint64_t DhcpServerApp::GetProcessingNs() const {
+  return m_processingNs;
+}
+
+void DhcpServerApp::SetAuthKey(uint32_t secretId, std::string secret) {
+  m_authKey = DhcpAuthKey(secretId, secret);
+  NS_LOG_INFO("Reply authentication enabled with secret ID " << secretId);
+}
+
 void DhcpServerApp::StartApplication() {
   m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
   m_socket->SetAllowBroadcast(true);
   InetSocketAddress local = InetSocketAddress(Ipv4Address::GetAny(), m_port);
   m_socket->Bind(local);
   m_socket->SetRecvCallback(MakeCallback(&DhcpServerApp::HandleRead, this));
+  m_startTime = Simulator::Now();
+  // RFC 3118 lets the replay counter be a timestamp. Starting from the clock
+  // keeps a restarted server ahead of the counters its predecessor used.
+  m_authReplay = std::max(m_authReplay, AuthReplaySeed());
+
+  if (!m_peers.empty()) {
+    m_syncSocket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+    m_syncSocket->Bind(InetSocketAddress(Ipv4Address::GetAny(), m_syncPort));
+    m_syncSocket->SetRecvCallback(MakeCallback(&DhcpServerApp::HandleSyncRead, this));
+  }
+
+  if (!m_journalPath.empty() && m_journal.Open(m_journalPath, m_poolSize > 0 ? m_poolSize : 1)) {
+    RecoverLeases();
+    m_compactEvent = Simulator::Schedule(m_journalCompactInterval, &DhcpServerApp::CompactJournal, this);
+  }
+
+  if (!m_peers.empty()) {
+    // Ask peers for their pool (including anything bound while we were down)
+    // and hand them whatever we recovered from the journal
+    SyncPeers(SYNC_HELLO, Ipv4Address::GetAny(), Mac48Address());
+    for (const auto &peer : m_peers) {
+      SendPoolDump(InetSocketAddress(peer.second, m_syncPort));
+    }
+    m_heartbeatEvent = Simulator::Schedule(m_syncInterval, &DhcpServerApp::SendHeartbeat, this);
+  }
   NS_LOG_INFO("Server application has started!");
 }
 
 void DhcpServerApp::StopApplication() {
+  Simulator::Cancel(m_heartbeatEvent);
+  Simulator::Cancel(m_compactEvent);
+  m_journal.Close();
   if (m_socket) {
     m_socket->Close();
   }
+  if (m_syncSocket) {
+    m_syncSocket->Close();
+  }
 }
 
-Ipv4Address DhcpServerApp::AllocateIp() {
-  Ipv4Address ip = m_currentIp;
-  uint32_t ipNum = ip.Get();
-  m_currentIp = Ipv4Address(ipNum + 1);
+bool DhcpServerApp::InPool(Ipv4Address ip) const {
+  return ip.Get() - m_poolStart.Get() < m_poolSize;
+}
+
+bool DhcpServerApp::MarkAllocated(Ipv4Address ip, Mac48Address chaddr) {
+  if (!InPool(ip)) return false;
+  if (!m_allocated.insert(std::make_pair(ip.Get(), chaddr)).second) return false;
+  if (chaddr != Mac48Address()) m_clientLeases[chaddr] = ip;
   m_remaining--;
-  return ip;
+  return true;
+}
+
+bool DhcpServerApp::ReleaseIp(Ipv4Address ip) {
+  auto it = m_allocated.find(ip.Get());
+  if (it == m_allocated.end()) return false;
+  auto lease = m_clientLeases.find(it->second);
+  if (lease != m_clientLeases.end() && lease->second == ip) m_clientLeases.erase(lease);
+  m_allocated.erase(it);
+  m_remaining++;
+  return true;
+}
+
+Ipv4Address DhcpServerApp::AllocateIp(Mac48Address chaddr) {
+  // Walk from the cursor through our own stride of the pool, then through the
+  // strides of peers that are down. A live peer's stride is never touched, so
+  // two servers can't bind the same address before the pool-sync arrives.
+  uint32_t start = m_poolStart.Get();
+  uint32_t cursor = m_currentIp.Get() - start;
+  for (uint32_t pass = 0; pass < 2; ++pass) {
+    for (uint32_t n = 0; n < m_poolSize; ++n) {
+      uint32_t off = (cursor + n) % m_poolSize;
+      uint32_t owner = off % m_numServers;
+      if (pass == 0 ? owner != m_serverIndex : owner == m_serverIndex || IsPeerAlive(owner)) continue;
+      if (m_allocated.count(start + off)) continue;
+      Ipv4Address ip(start + off);
+      MarkAllocated(ip, chaddr);
+      m_currentIp = Ipv4Address(start + (off + 1) % m_poolSize);
+      m_allocCount++;
+      SyncPeers(SYNC_BNDUPD, ip, chaddr);
+      return ip;
+    }
+  }
+  return Ipv4Address::GetAny(); // our share of the pool is used up
+}
+
+void DhcpServerApp::RecoverLeases() {
+  auto begin = std::chrono::steady_clock::now();
+  std::map<uint32_t, DhcpLeaseJournal::Record> live = m_journal.Recover();
+  uint32_t recovered = 0;
+  for (const auto &entry : live) {
+    Ipv4Address ip(entry.first);
+    Mac48Address chaddr;
+    chaddr.CopyFrom(entry.second.chaddr);
+    if (!MarkAllocated(ip, chaddr)) continue;
+    m_leaseTable[entry.second.xid] = ip;
+    // Bindings come back in address order: resume allocating after the last one
+    m_currentIp = Ipv4Address(m_poolStart.Get() + (entry.first - m_poolStart.Get() + 1) % m_poolSize);
+    recovered++;
+  }
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+  NS_LOG_INFO("Recovered " << recovered << " leases from journal in " << ms << " ms, "
+              << m_remaining << " addresses left");
+}
+
+void DhcpServerApp::CompactJournal() {
+  m_journal.Compact();
+  m_compactEvent = Simulator::Schedule(m_journalCompactInterval, &DhcpServerApp::CompactJournal, this);
+}
+
+uint8_t DhcpServerApp::LoadBalanceHash(Mac48Address chaddr) {
+  uint8_t key[6];
+  chaddr.CopyTo(key);
+  uint8_t hash = 6;
+  for (int i = 6; i > 0;) {
+    hash = s_loadbMxTbl[hash ^ key[--i]];
+  }
+  return hash;
+}
+
+bool DhcpServerApp::IsPeerAlive(uint32_t index) const {
+  auto it = m_peerLastSeen.find(index);
+  if (it == m_peerLastSeen.end()) {
+    // Not heard from yet: give it one timeout after our start to announce itself
+    return Simulator::Now() - m_startTime <= m_peerTimeout;
+  }
+  return Simulator::Now() - it->second <= m_peerTimeout;
+}
+
+bool DhcpServerApp::ServesBucket(uint8_t bucket) const {
+  uint32_t owner = bucket % m_numServers;
+  if (owner == m_serverIndex) return true;
+  if (IsPeerAlive(owner)) return false;
+  // Owner is down: the lowest-indexed live server takes over its buckets
+  for (uint32_t i = 0; i < m_numServers; ++i) {
+    if (i == m_serverIndex) return true;
+    if (i != owner && IsPeerAlive(i)) return false;
+  }
+  return false;
+}
+
+static void WriteSyncRecord(uint8_t *rec, Ipv4Address ip, Mac48Address chaddr) {
+  uint32_t ipNum = ip.Get();
+  rec[0] = (ipNum >> 24) & 0xFF;
+  rec[1] = (ipNum >> 16) & 0xFF;
+  rec[2] = (ipNum >> 8) & 0xFF;
+  rec[3] = ipNum & 0xFF;
+  chaddr.CopyTo(&rec[4]);
+}
+
+void DhcpServerApp::SendPoolSync(uint8_t type, Ipv4Address ip, Mac48Address chaddr, Address to) {
+  uint8_t buf[SYNC_HDR_LEN + SYNC_REC_LEN];
+  buf[0] = type;
+  buf[1] = m_serverIndex & 0xFF;
+  WriteSyncRecord(&buf[SYNC_HDR_LEN], ip, chaddr);
+  m_syncSocket->SendTo(Create<Packet>(buf, sizeof(buf)), 0, to);
+}
+
+void DhcpServerApp::SendPoolDump(Address to) {
+  uint8_t buf[SYNC_HDR_LEN + SYNC_MAX_RECORDS * SYNC_REC_LEN];
+  buf[0] = SYNC_BNDUPD;
+  buf[1] = m_serverIndex & 0xFF;
+  uint32_t n = 0;
+  for (auto it = m_allocated.begin(); it != m_allocated.end();) {
+    WriteSyncRecord(&buf[SYNC_HDR_LEN + n * SYNC_REC_LEN], Ipv4Address(it->first), it->second);
+    n++;
+    if (n == SYNC_MAX_RECORDS || ++it == m_allocated.end()) {
+      m_syncSocket->SendTo(Create<Packet>(buf, SYNC_HDR_LEN + n * SYNC_REC_LEN), 0, to);
+      n = 0;
+    }
+  }
+}
+
+void DhcpServerApp::SyncPeers(uint8_t type, Ipv4Address ip, Mac48Address chaddr) {
+  for (const auto &peer : m_peers) {
+    SendPoolSync(type, ip, chaddr, InetSocketAddress(peer.second, m_syncPort));
+  }
+}
+
+void DhcpServerApp::SendHeartbeat() {
+  SyncPeers(SYNC_HEARTBEAT, Ipv4Address::GetAny(), Mac48Address());
+  m_heartbeatEvent = Simulator::Schedule(m_syncInterval, &DhcpServerApp::SendHeartbeat, this);
+}
+
+void DhcpServerApp::HandleSyncRead(Ptr<Socket> socket) {
+  Address from;
+  Ptr<Packet> packet;
+  while ((packet = socket->RecvFrom(from))) {
+    uint32_t size = packet->GetSize();
+    if (size < SYNC_HDR_LEN + SYNC_REC_LEN || size > SYNC_HDR_LEN + SYNC_MAX_RECORDS * SYNC_REC_LEN) continue;
+    uint8_t data[SYNC_HDR_LEN + SYNC_MAX_RECORDS * SYNC_REC_LEN];
+    packet->CopyData(data, size);
+    // Only a registered peer, from its own address, may touch the pool
+    uint32_t index = data[1];
+    Ipv4Address source = InetSocketAddress::ConvertFrom(from).GetIpv4();
+    auto peer = m_peers.find(index);
+    if (peer == m_peers.end() || peer->second != source) {
+      NS_LOG_WARN("Dropped pool-sync message claiming server " << index << " from " << source);
+      continue;
+    }
+
+    // Peer just started, or is back after we declared it down: bring its
+    // view of the pool up to date
+    bool seen = m_peerLastSeen.find(index) != m_peerLastSeen.end();
+    if (data[0] == SYNC_HELLO || (seen && !IsPeerAlive(index))) {
+      NS_LOG_INFO("Peer server " << index << " is up, syncing " << m_allocated.size() << " bindings");
+      SendPoolDump(InetSocketAddress(source, m_syncPort));
+    }
+    m_peerLastSeen[index] = Simulator::Now();
+
+    for (uint32_t off = SYNC_HDR_LEN; off + SYNC_REC_LEN <= size; off += SYNC_REC_LEN) {
+      Ipv4Address ip((data[off] << 24) | (data[off + 1] << 16) | (data[off + 2] << 8) | data[off + 3]);
+      Mac48Address chaddr;
+      chaddr.CopyFrom(&data[off + 4]);
+      if (data[0] == SYNC_BNDUPD && MarkAllocated(ip, chaddr)) {
+        m_journal.Append(DhcpLeaseJournal::BIND, ip, 0, chaddr);
+      } else if (data[0] == SYNC_BNDUPD && InPool(ip) && m_allocated[ip.Get()] != chaddr) {
+        // Only possible if we took over a stride while its owner was still up
+        NS_LOG_WARN("Peer server " << index << " bound " << ip << " which we hold for another client");
+      } else if (data[0] == SYNC_RELEASE && ReleaseIp(ip)) {
+        m_journal.Append(DhcpLeaseJournal::RELEASE, ip, 0, chaddr);
+      }
+    }
+  }
 }
 
 void DhcpServerApp::HandleRead(Ptr<Socket> socket) {
+  // UdpSocket calls back once per delivered datagram, so this normally sees
+  // one packet; batching under emulation happens in the device reader.
   Address from;
-  Ptr<Packet> packet = socket->RecvFrom(from);
+  Ptr<Packet> packet;
+  while ((packet = socket->RecvFrom(from))) {
+    if (!m_measureCost) {
+      HandleMessage(socket, packet, from);
+      continue;
+    }
+    auto begin = std::chrono::steady_clock::now();
+    HandleMessage(socket, packet, from);
+    m_processingNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - begin).count();
+  }
+}
 
+void DhcpServerApp::HandleMessage(Ptr<Socket> socket, Ptr<Packet> packet, Address from) {
   uint8_t data[300];
   packet->CopyData(data, 300);
 
   if (packet->GetSize() < 240 || data[236] != 99 || data[237] != 130) return;
+  m_rxCount++;
 
   uint8_t msgType = 0;
   Ipv4Address requestedIp = Ipv4Address::GetAny();
@@ -91,12 +410,15 @@ void DhcpServerApp::HandleRead(Ptr<Socket> socket) {
   chaddr.CopyFrom(&data[28]);
 
   if (msgType == 1 ) {  // DHCPDISCOVER
+    if (m_numServers > 1 && !ServesBucket(LoadBalanceHash(chaddr))) {
+      return; // another server in the group owns this client
+    }
     Time now = Simulator::Now();
     if (m_defenceOn) {
       // Maintain a rolling log of DISCOVER timestamps 
 
       while(!m_recentDiscoverTimes.empty() && (now - m_recentDiscoverTimes.front() > m_monitorWindow)) {
-        m_recentDiscoverTimes.erase(m_recentDiscoverTimes.begin());
+        m_recentDiscoverTimes.pop_front();
       }
       m_recentDiscoverTimes.push_back(now);
 
@@ -107,9 +429,18 @@ void DhcpServerApp::HandleRead(Ptr<Socket> socket) {
         return; // Ignore this request
       }
     }
-    if(m_remaining > 0) {
-    Ipv4Address offeredIp = AllocateIp();
+    auto bound = m_clientLeases.find(chaddr);
+    if (bound != m_clientLeases.end() || m_remaining > 0) {
+    // A client we already know gets its old address back
+    Ipv4Address offeredIp = bound != m_clientLeases.end() ? bound->second : AllocateIp(chaddr);
+    if (offeredIp == Ipv4Address::GetAny()) {
+      NS_LOG_INFO("No free address in this server's share of the pool for " << chaddr);
+      return;
+    }
     m_leaseTable[xid] = offeredIp;
+    if (bound == m_clientLeases.end()) {
+      m_journal.Append(DhcpLeaseJournal::BIND, offeredIp, xid, chaddr);
+    }
     Time jitter = MilliSeconds(rand() % 2);
     Simulator::Schedule(m_delay + jitter, [=]() {
       Ptr<Packet> offer = BuildDhcpOfferPacket(xid, chaddr, offeredIp);
@@ -118,6 +449,34 @@ void DhcpServerApp::HandleRead(Ptr<Socket> socket) {
     });
    }
   
+  } else if (msgType == 3 && requestedIp != Ipv4Address::GetAny() &&
+             m_leaseTable.find(xid) == m_leaseTable.end()) {
+    // INIT-REBOOT: no offer outstanding, the client asks for its previous address
+    if (m_numServers > 1 && !ServesBucket(LoadBalanceHash(chaddr))) return;
+    if (!InPool(requestedIp)) return; // not our address, stay silent
+
+    auto owner = m_allocated.find(requestedIp.Get());
+    auto bound = m_clientLeases.find(chaddr);
+    bool ok = (owner == m_allocated.end() && bound == m_clientLeases.end()) ||
+              (owner != m_allocated.end() && owner->second == chaddr);
+    if (!ok) {
+      Simulator::Schedule(m_delay, [=]() {
+        socket->SendTo(BuildDhcpNakPacket(xid, chaddr), 0, from);
+        NS_LOG_INFO("Sent DHCPNAK for " << requestedIp << " to " << chaddr);
+      });
+      return;
+    }
+    if (MarkAllocated(requestedIp, chaddr)) {
+      // Binding was lost (e.g. restart without journal): take the client's word for it
+      m_allocCount++;
+      m_journal.Append(DhcpLeaseJournal::BIND, requestedIp, xid, chaddr);
+      SyncPeers(SYNC_BNDUPD, requestedIp, chaddr);
+    }
+    Simulator::Schedule(m_delay, [=]() {
+      socket->SendTo(BuildDhcpAckPacket(xid, chaddr, requestedIp), 0, from);
+      NS_LOG_INFO("Sent DHCPACK for " << requestedIp << " (INIT-REBOOT)");
+    });
+
   } else if (msgType == 3) {  // DHCPREQUEST
     Ipv4Address lease = (requestedIp == Ipv4Address::GetAny()) ? m_leaseTable[xid] : requestedIp;
 
@@ -126,9 +485,25 @@ void DhcpServerApp::HandleRead(Ptr<Socket> socket) {
       socket->SendTo(ack, 0, from);
       NS_LOG_INFO("Sent DHCPACK for " << lease);
     });
+
+  } else if (msgType == 7) {  // DHCPRELEASE
+    Ipv4Address ciaddr((data[12] << 24) | (data[13] << 16) | (data[14] << 8) | data[15]);
+    auto owner = m_allocated.find(ciaddr.Get());
+    if (owner == m_allocated.end() || owner->second != chaddr) return;
+    ReleaseIp(ciaddr);
+    m_releaseCount++;
+    m_journal.Append(DhcpLeaseJournal::RELEASE, ciaddr, xid, chaddr);
+    SyncPeers(SYNC_RELEASE, ciaddr, chaddr);
+    NS_LOG_INFO("Released " << ciaddr << " from " << chaddr);
   }
 }
 
+// Appends the authentication option when a key is set; returns the packet length
+uint32_t DhcpServerApp::SignReply(uint8_t *buf, uint32_t end) {
+  if (!m_authKey.IsSet()) return end + 1;
+  return m_authKey.Sign(buf, end, ++m_authReplay);
+}
+
 Ptr<Packet> DhcpServerApp::BuildDhcpOfferPacket(uint32_t xid, Mac48Address chaddr, Ipv4Address yiaddr) {
   uint8_t buf[300] = {0};
   buf[0] = 2; // BOOTREPLY
@@ -148,7 +523,7 @@ Ptr<Packet> DhcpServerApp::BuildDhcpOfferPacket(uint32_t xid, Mac48Address chadd
   buf[236] = 99; buf[237] = 130; buf[238] = 83; buf[239] = 99;
   buf[240] = 53; buf[241] = 1; buf[242] = 2; // DHCP Message Type: Offer
   buf[243] = 255;
-  return Create<Packet>(buf, 244);
+  return Create<Packet>(buf, SignReply(buf, 243));
 }
 
 Ptr<Packet> DhcpServerApp::BuildDhcpAckPacket(uint32_t xid, Mac48Address chaddr, Ipv4Address yiaddr) {
@@ -169,7 +544,22 @@ Ptr<Packet> DhcpServerApp::BuildDhcpAckPacket(uint32_t xid, Mac48Address chaddr,
   buf[236] = 99; buf[237] = 130; buf[238] = 83; buf[239] = 99;
   buf[240] = 53; buf[241] = 1; buf[242] = 5; // DHCPACK
   buf[243] = 255;
-  return Create<Packet>(buf, 244);
+  return Create<Packet>(buf, SignReply(buf, 243));
+}
+
+Ptr<Packet> DhcpServerApp::BuildDhcpNakPacket(uint32_t xid, Mac48Address chaddr) {
+  uint8_t buf[300] = {0};
+  buf[0] = 2; buf[1] = 1; buf[2] = 6; buf[3] = 0;
+  buf[4] = (xid >> 24) & 0xFF;
+  buf[5] = (xid >> 16) & 0xFF;
+  buf[6] = (xid >> 8) & 0xFF;
+  buf[7] = xid & 0xFF;
+
+  chaddr.CopyTo(&buf[28]);
+  buf[236] = 99; buf[237] = 130; buf[238] = 83; buf[239] = 99;
+  buf[240] = 53; buf[241] = 1; buf[242] = 6; // DHCPNAK
+  buf[243] = 255;
+  return Create<Packet>(buf, SignReply(buf, 243));
 }
 
-} // namespace ns3
\ No newline at end of file
+} // namespace ns3
@@ -8,7 +8,13 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/mac48-address.h"
+#include "ns3/event-id.h"
+#include "dhcp-auth.h"
+#include "dhcp-lease-journal.h"
+#include <deque>
 #include <map>
+#include <string>
+#include <vector>
 
 namespace ns3 {
 
@@ -21,20 +27,70 @@ public:
 
   void Setup(Ipv4Address startIp, uint32_t poolSize, uint16_t port, Time responseDelay);
 
+  // RFC 3074 load balancing: this server answers only the chaddr hash buckets
+  // it owns and takes over a peer's buckets once the peer stops syncing.
+  // Pool-sync messages are only accepted from a registered peer's address.
+  void SetLoadBalancing(uint32_t serverIndex, uint32_t numServers);
+  void AddPeer(uint32_t peerIndex, Ipv4Address peerIp);
+
+  // Persist bindings to an mmap'd journal and recover them on start, so a
+  // restarted (or pre-loaded) server comes up with its pool already occupied.
+  void SetLeaseJournal(std::string path, Time compactInterval = Seconds(5));
+
+  uint32_t GetRxCount() const;         // DHCP messages received
+  uint32_t GetAllocationCount() const; // addresses newly bound by this server
+  uint32_t GetReleaseCount() const;    // addresses returned by DHCPRELEASE
+  uint32_t GetRemaining() const;
+
+  // Wall-clock time spent handling DHCP messages; only meaningful under the
+  // real-time simulator, where it is the model's true per-packet cost.
+  void EnableCostMeasurement(bool on);
+  uint64_t GetProcessingNs() const;
+
+  // RFC 3118-style authentication: sign every reply with this server's key
+  void SetAuthKey(uint32_t secretId, std::string secret);
+
 protected:
   virtual void StartApplication(void);
   virtual void StopApplication(void);
 
 private:
   void HandleRead(Ptr<Socket> socket);
-  Ipv4Address AllocateIp();
+  void HandleMessage(Ptr<Socket> socket, Ptr<Packet> packet, Address from);
+  Ipv4Address AllocateIp(Mac48Address chaddr);
+  bool MarkAllocated(Ipv4Address ip, Mac48Address chaddr);
+  bool ReleaseIp(Ipv4Address ip);
+  bool InPool(Ipv4Address ip) const;
+
+  static uint8_t LoadBalanceHash(Mac48Address chaddr);
+  bool ServesBucket(uint8_t bucket) const;
+  bool IsPeerAlive(uint32_t index) const;
+  void SendHeartbeat();
+  void SendPoolSync(uint8_t type, Ipv4Address ip, Mac48Address chaddr, Address to);
+  void SendPoolDump(Address to);
+  void SyncPeers(uint8_t type, Ipv4Address ip, Mac48Address chaddr);
+  void HandleSyncRead(Ptr<Socket> socket);
+
+  void RecoverLeases();
+  void CompactJournal();
 
   Ptr<Packet> BuildDhcpOfferPacket(uint32_t xid, Mac48Address chaddr, Ipv4Address yiaddr);
   Ptr<Packet> BuildDhcpAckPacket(uint32_t xid, Mac48Address chaddr, Ipv4Address yiaddr);
+  Ptr<Packet> BuildDhcpNakPacket(uint32_t xid, Mac48Address chaddr);
+  uint32_t SignReply(uint8_t *buf, uint32_t end);
 
   Ptr<Socket> m_socket;
   Ipv4Address m_currentIp;
+  Ipv4Address m_poolStart;
+  uint32_t m_poolSize = 0;
   uint32_t m_remaining;
+  std::map<uint32_t, Mac48Address> m_allocated; // address -> chaddr, bound by us or a peer
+  std::map<Mac48Address, Ipv4Address> m_clientLeases; // chaddr -> bound address
+  uint32_t m_rxCount = 0;
+  uint32_t m_allocCount = 0;
+  uint32_t m_releaseCount = 0;
+  bool m_measureCost = false;
+  uint64_t m_processingNs = 0;
   uint16_t m_port;
   Time m_delay;
 
@@ -42,10 +98,32 @@ private:
   bool m_defenceOn = false; 
   Time m_monitorWindow = Seconds(1);
   uint32_t m_discoverThreshold = 20;
-  std::vector<Time> m_recentDiscoverTimes; // timestamps of received DHCPDISCOVER messages
+  std::deque<Time> m_recentDiscoverTimes; // timestamps of received DHCPDISCOVER messages
   
 
   std::map<uint32_t, Ipv4Address> m_leaseTable;  // xid -> offered IP
+
+  // for load balancing / failover between cooperating servers
+  uint32_t m_serverIndex = 0;
+  uint32_t m_numServers = 1;
+  std::map<uint32_t, Ipv4Address> m_peers; // peer server index -> address
+  std::map<uint32_t, Time> m_peerLastSeen; // peer server index -> last sync message
+  Time m_startTime;
+  Ptr<Socket> m_syncSocket;
+  uint16_t m_syncPort = 647; // DHCP failover port
+  Time m_syncInterval = MilliSeconds(200);
+  Time m_peerTimeout = MilliSeconds(600);
+  EventId m_heartbeatEvent;
+
+  // for the persistent lease journal
+  DhcpLeaseJournal m_journal;
+  std::string m_journalPath;
+  Time m_journalCompactInterval;
+  EventId m_compactEvent;
+
+  // for reply authentication
+  DhcpAuthKey m_authKey;
+  uint64_t m_authReplay = 0; // monotonic replay-detection counter, seeded from the clock on start
 };
 
 } // namespace ns3